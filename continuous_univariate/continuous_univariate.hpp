@@ -25,130 +25,1662 @@ SOFTWARE.
 #ifndef CONTINUOUS_UNIVARIATE_HPP_
 #define CONTINUOUS_UNIVARIATE_HPP_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <random>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "simd.hpp"
+#include "special_functions.hpp"
+#include "zoo_random.hpp"
+
 namespace zoo {
 
 template <class real> constexpr real pi = real{3.14159265358979323846264338L};
 
-template <class real> class ContinuousUnivariate {
-private:
-  std::random_device mRd{};
-
+// Engine may be any UniformRandomBitGenerator; it defaults to std::mt19937.
+template <class real, class Engine = std::mt19937> class ContinuousUnivariate {
 protected:
-  std::mt19937 mMt{mRd()};
+  Engine mEngine;
 
 public:
+  using engine_type = Engine;
+
+  // By default the engine is seeded from the process-wide zoo::SeedSource::global()
+  ContinuousUnivariate() : mEngine(make_seeded_engine<Engine>()) {}
+  explicit ContinuousUnivariate(Engine engine) : mEngine(std::move(engine)) {}
+  explicit ContinuousUnivariate(const std::uint64_t seed)
+      : mEngine(make_seeded_engine<Engine>(seed)) {}
+  virtual ~ContinuousUnivariate() = default;
+
+  Engine &engine() { return mEngine; }
+
   virtual real pdf(real x) = 0;
   virtual real log_pdf(real x) = 0;
   virtual real rand() = 0;
+
+  // P(X <= x), its log, P(X > x), and the inverse of the cdf. The log_cdf and survival defaults
+  // are only fallbacks, log(cdf) and 1 - cdf, which lose the far tails to underflow and rounding.
+  // Normal and Beta override both and keep that precision.
+  virtual real cdf(real x) = 0;
+  virtual real log_cdf(real x) { return std::log(this->cdf(x)); }
+  virtual real survival(real x) { return real{1.0} - this->cdf(x); }
+  virtual real quantile(real p) = 0;
+
+  // Batch overloads: evaluate n points from x into out with a single virtual dispatch. The
+  // defaults fall back to the scalar methods; distributions override them with tight loops.
+  virtual void pdf(const real *x, real *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = this->pdf(x[i]);
+    }
+  }
+
+  virtual void log_pdf(const real *x, real *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = this->log_pdf(x[i]);
+    }
+  }
+
+  virtual void cdf(const real *x, real *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = this->cdf(x[i]);
+    }
+  }
+
+  virtual void log_cdf(const real *x, real *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = this->log_cdf(x[i]);
+    }
+  }
+
+  virtual void survival(const real *x, real *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = this->survival(x[i]);
+    }
+  }
+
+  // out[i] = quantile(p[i])
+  virtual void quantile(const real *p, real *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = this->quantile(p[i]);
+    }
+  }
+
+  // Write n draws into existing storage. Distributions override this to generate a whole block
+  // without a virtual call per draw.
+  virtual void fill(real *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = this->rand();
+    }
+  }
+
+  // Resize sample to n and fill it, reusing its capacity rather than allocating.
+  void randn_into(std::vector<real> &sample, std::size_t n) {
+    sample.resize(n);
+    this->fill(sample.data(), n);
+  }
+
   virtual std::vector<real> randn(std::size_t n) {
     std::vector<real> sample(n);
-    for (auto &x : sample) {
-      x = this->rand();
+    this->fill(sample.data(), n);
+    return sample;
+  }
+
+  // Write n draws using the given engine instead of the member one. This must not modify the
+  // distribution, so that it can be called concurrently with different engines.
+  virtual void fill(Engine &engine, real *out, std::size_t n) const = 0;
+
+  // Draws per independent stream in fill_parallel. Fixing this, rather than deriving it from the
+  // number of threads, is what makes the output independent of the thread count.
+  static constexpr std::size_t parallel_block_size = std::size_t{1} << 16u;
+
+  // Write n draws using up to n_threads threads. The output is cut into blocks of
+  // parallel_block_size, and block b is drawn from stream b of a family seeded once from the member
+  // engine, so the result is identical for any number of threads.
+  void fill_parallel(real *out, const std::size_t n,
+                     const unsigned n_threads = std::thread::hardware_concurrency()) {
+    const std::uint64_t seed = std::uniform_int_distribution<std::uint64_t>{}(mEngine);
+    const std::size_t n_blocks = (n + parallel_block_size - 1) / parallel_block_size;
+
+    std::atomic<std::size_t> next_block{0};
+    const auto worker = [&]() {
+      for (std::size_t b = next_block++; b < n_blocks; b = next_block++) {
+        Engine engine = make_stream_engine<Engine>(seed, b);
+        const std::size_t first = b * parallel_block_size;
+        this->fill(engine, out + first, std::min(parallel_block_size, n - first));
+      }
+    };
+
+    const std::size_t n_workers =
+        std::clamp<std::size_t>(n_threads, 1, std::max<std::size_t>(n_blocks, 1));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < n_workers; ++t) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+      thread.join();
     }
+  }
+
+  std::vector<real> randn_parallel(const std::size_t n,
+                                   const unsigned n_threads = std::thread::hardware_concurrency()) {
+    std::vector<real> sample(n);
+    this->fill_parallel(sample.data(), n, n_threads);
     return sample;
   }
 };
 
-template <class real> class Beta : public ContinuousUnivariate<real> {
+// Static counterpart of ContinuousUnivariate. A distribution deriving from
+// StaticContinuousUnivariate<Derived, real> holds only its parameters and cached constants and
+// defines const, non-virtual pdf, log_pdf, cdf, log_cdf, survival, quantile and rand(Engine &), so
+// templated code calling it on a known type is fully inlined. The batch forms below loop over
+// those; distributions may define faster ones.
+template <class Derived, class real> class StaticContinuousUnivariate {
+private:
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
+public:
+  using real_type = real;
+
+  void pdf(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = derived().pdf(x[i]);
+    }
+  }
+
+  void log_pdf(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = derived().log_pdf(x[i]);
+    }
+  }
+
+  void cdf(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = derived().cdf(x[i]);
+    }
+  }
+
+  void log_cdf(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = derived().log_cdf(x[i]);
+    }
+  }
+
+  void survival(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = derived().survival(x[i]);
+    }
+  }
+
+  void quantile(const real *p, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = derived().quantile(p[i]);
+    }
+  }
+
+  template <class Engine> void fill(Engine &engine, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = derived().rand(engine);
+    }
+  }
+
+  template <class Engine> std::vector<real> randn(Engine &engine, const std::size_t n) const {
+    std::vector<real> sample(n);
+    derived().fill(engine, sample.data(), n);
+    return sample;
+  }
+
+protected:
+  // Only derived distributions construct, copy or destroy the base
+  StaticContinuousUnivariate() = default;
+  StaticContinuousUnivariate(const StaticContinuousUnivariate &) = default;
+  StaticContinuousUnivariate &operator=(const StaticContinuousUnivariate &) = default;
+  ~StaticContinuousUnivariate() = default;
+};
+
+// Implements the virtual ContinuousUnivariate interface as a thin layer over a static
+// distribution Dist, which owns the parameters; this class adds only the engine.
+template <class Dist, class Engine>
+class ContinuousUnivariateAdapter
+    : public ContinuousUnivariate<typename Dist::real_type, Engine> {
+private:
+  using real = typename Dist::real_type;
+  using Base = ContinuousUnivariate<real, Engine>;
+
+protected:
+  Dist mDist;
+
+public:
+  explicit ContinuousUnivariateAdapter(Dist dist) : mDist(std::move(dist)) {}
+
+  ContinuousUnivariateAdapter(Dist dist, Engine engine)
+      : Base(std::move(engine)), mDist(std::move(dist)) {}
+
+  ContinuousUnivariateAdapter(Dist dist, const std::uint64_t seed)
+      : Base(seed), mDist(std::move(dist)) {}
+
+  // The underlying static distribution
+  const Dist &distribution() const { return mDist; }
+
+  real pdf(const real x) override { return mDist.pdf(x); }
+  real log_pdf(const real x) override { return mDist.log_pdf(x); }
+  real rand() override { return mDist.rand(this->mEngine); }
+  real cdf(const real x) override { return mDist.cdf(x); }
+  real log_cdf(const real x) override { return mDist.log_cdf(x); }
+  real survival(const real x) override { return mDist.survival(x); }
+  real quantile(const real p) override { return mDist.quantile(p); }
+
+  void pdf(const real *x, real *out, const std::size_t n) override { mDist.pdf(x, out, n); }
+
+  void log_pdf(const real *x, real *out, const std::size_t n) override {
+    mDist.log_pdf(x, out, n);
+  }
+
+  void cdf(const real *x, real *out, const std::size_t n) override { mDist.cdf(x, out, n); }
+
+  void log_cdf(const real *x, real *out, const std::size_t n) override {
+    mDist.log_cdf(x, out, n);
+  }
+
+  void survival(const real *x, real *out, const std::size_t n) override {
+    mDist.survival(x, out, n);
+  }
+
+  void quantile(const real *p, real *out, const std::size_t n) override {
+    mDist.quantile(p, out, n);
+  }
+
+  void fill(real *out, const std::size_t n) override { mDist.fill(this->mEngine, out, n); }
+
+  void fill(Engine &engine, real *out, const std::size_t n) const override {
+    mDist.fill(engine, out, n);
+  }
+};
+
+// Sampler by numerical inversion of the cdf, after Derflinger, Hörmann & Leydold (2010), "Random
+// variate generation by numerical inversion when only the density is known" (PINV). The support,
+// less tails of mass u_resolution / 20, is split into intervals, and on each the quantile function
+// is interpolated by a Newton polynomial in u through Chebyshev points. Intervals are halved in u
+// until the u-error |F(x(u)) - u| between the nodes is below u_resolution. The one exception is
+// next to a pole of the density, where the mass between adjacent representable x can exceed the
+// resolution. Unlike PINV, the nodes are taken from the distribution's own cdf and quantile
+// rather than by integrating its pdf. A draw then costs one uniform, a guide table lookup and a
+// polynomial evaluation.
+template <class real> class InverseCdfSampler {
+private:
+  static constexpr int order = 5;
+
+  // x(u) = coeffs[0] + (t - nodes[0]) (coeffs[1] + (t - nodes[1]) (...)) for t = u - u_start
+  struct Interval {
+    real u_start;
+    real width;
+    real nodes[order];
+    real coeffs[order + 1];
+
+    real operator()(const real t) const {
+      real x = coeffs[order];
+      for (int k = order - 1; k >= 0; --k) {
+        x = coeffs[k] + (t - nodes[k]) * x;
+      }
+      return x;
+    }
+  };
+
+  std::vector<Interval> mIntervals;
+
+  // Left ends in u of the intervals, followed by an infinite sentinel
+  std::vector<real> mStarts;
+
+  // Guide table of Chen & Asau (1974): mGuide[g] is the interval containing u = g / mGuide.size()
+  std::vector<std::size_t> mGuide;
+
+  real mUResolution;
+
+  // Straight line from xa to xb across the interval, which keeps x(u) within [xa, xb]
+  static void set_linear(const real xa, const real xb, Interval &interval) {
+    std::fill(std::begin(interval.nodes), std::end(interval.nodes), real{0.0});
+    std::fill(std::begin(interval.coeffs), std::end(interval.coeffs), real{0.0});
+    interval.coeffs[0] = xa;
+    interval.coeffs[1] = interval.width > real{0.0} ? (xb - xa) / interval.width : real{0.0};
+  }
+
+  // Fits the interval [xa, xb], returning whether it meets the u-resolution. The nodes are
+  // measured from the nearer tail, so that they keep their precision where the cdf approaches one.
+  template <class Dist>
+  bool build_interval(const Dist &dist, const real xa, const real xb, Interval &interval) const {
+    const real ua = dist.cdf(xa);
+    const bool upper = ua > real{0.5};
+    const real sa = upper ? dist.survival(xa) : real{0.0};
+    const auto offset = [&](const real x) {
+      return upper ? sa - dist.survival(x) : dist.cdf(x) - ua;
+    };
+
+    real x[order + 1];
+    real t[order + 1];
+    for (int j = 0; j <= order; ++j) {
+      const real cheb = real{0.5} * (real{1.0} - std::cos(pi<real> * real(j) / real(order)));
+      x[j] = j == order ? xb : xa + (xb - xa) * cheb;
+      t[j] = offset(x[j]);
+    }
+
+    interval.u_start = ua;
+    interval.width = t[order];
+
+    bool increasing = t[0] == real{0.0};
+    for (int j = 0; j < order; ++j) {
+      increasing = increasing && t[j + 1] > t[j];
+    }
+    if (!increasing) {
+      set_linear(xa, xb, interval);
+      return false;
+    }
+
+    // Newton divided differences
+    real c[order + 1];
+    std::copy(std::begin(x), std::end(x), std::begin(c));
+    for (int k = 1; k <= order; ++k) {
+      for (int j = order; j >= k; --j) {
+        c[j] = (c[j] - c[j - 1]) / (t[j] - t[j - k]);
+      }
+    }
+    std::copy(std::begin(t), std::begin(t) + order, std::begin(interval.nodes));
+    std::copy(std::begin(c), std::end(c), std::begin(interval.coeffs));
+
+    // Check the u-error, and that x stays between the neighbouring nodes, at the quarter points
+    // between the nodes and at points approaching either end, where a pole of the density makes
+    // the cdf most sensitive to x. Near such a pole the cdf can step by more than the resolution
+    // between representable x, so the bound is widened by the mass of a few ulps.
+    const real ulp_mass = interval.width / (xb - xa) * real{4.0} *
+                          std::numeric_limits<real>::epsilon() *
+                          std::max(std::fabs(xa), std::fabs(xb));
+    const auto within = [&](const real t_test, const int j) {
+      const real x_test = interval(t_test);
+      return x_test >= x[j] && x_test <= x[j + 1] &&
+             std::fabs(offset(x_test) - t_test) <= mUResolution + ulp_mass;
+    };
+    for (int j = 0; j < order; ++j) {
+      for (int k = 1; k <= 3; ++k) {
+        if (!within(t[j] + real(k) * real{0.25} * (t[j + 1] - t[j]), j)) {
+          return false;
+        }
+      }
+    }
+    real scale{0.25};
+    for (int k = 0; k < 4; ++k) {
+      scale *= real{0.25};
+      if (!within(scale * t[1], 0) ||
+          !within(t[order] - scale * (t[order] - t[order - 1]), order - 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+public:
+  // Builds the table for dist, a static distribution with cdf, survival and quantile. The
+  // u-resolution must be well above the precision of real and below one.
+  template <class Dist>
+  InverseCdfSampler(const Dist &dist, const real u_resolution) : mUResolution(u_resolution) {
+    assert(u_resolution >= real{256.0} * std::numeric_limits<real>::epsilon());
+    assert(u_resolution < real{1.0});
+
+    // Interval ends are placed in u, through the quantile function, rather than in x, so that the
+    // intervals shrink in x, geometrically if need be, toward a pole of the density. An interval
+    // whose polynomial misses the resolution is halved in u. One no wider in u than the resolution
+    // meets it with a straight line, since x(u) then stays within the interval, and so does one
+    // between adjacent x up to the mass between them.
+    const real tail = real{0.05} * u_resolution;
+    const real u_end = real{1.0} - tail;
+    real du = (u_end - tail) / real{64.0};
+    real ua = tail;
+    real xa = dist.quantile(tail);
+    while (ua < u_end) {
+      // At least an ulp past xa, where the cdf steps across ub between adjacent x
+      const auto end_at = [&](const real u) {
+        const real next = std::nextafter(xa, std::numeric_limits<real>::infinity());
+        return std::max(dist.quantile(u), next);
+      };
+      real ub = u_end - ua < real{1.5} * du ? u_end : ua + du;
+      real xb = end_at(ub);
+      Interval interval;
+      while (!build_interval(dist, xa, xb, interval)) {
+        const bool adjacent = !(std::nextafter(xa, xb) < xb);
+        if (ub - ua <= u_resolution || adjacent) {
+          set_linear(xa, xb, interval);
+
+          // Only where the cdf steps by more than the resolution between adjacent x, as it can at
+          // a pole of the density, is the resolution out of reach
+          assert(interval.width <= real{2.0} * u_resolution || adjacent);
+          break;
+        }
+        ub = ua + real{0.5} * (ub - ua);
+        xb = end_at(ub);
+      }
+
+      // Intervals without mass are never drawn from
+      if (interval.width > real{0.0}) {
+        mIntervals.push_back(interval);
+      }
+      du = real{1.5} * (ub - ua);
+
+      // Carry on from where xb lies in u, which is past ub if the cdf steps there
+      ua = std::max(ub, dist.cdf(xb));
+      xa = xb;
+    }
+    assert(!mIntervals.empty());
+
+    mStarts.reserve(mIntervals.size() + 1);
+    for (const Interval &interval : mIntervals) {
+      mStarts.push_back(interval.u_start);
+    }
+    mStarts.push_back(std::numeric_limits<real>::infinity());
+
+    // Several cells per interval keep the forward search from the guide to a step or two
+    mGuide.resize(4 * mIntervals.size());
+    std::size_t j = 0;
+    for (std::size_t g = 0; g < mGuide.size(); ++g) {
+      const real u = static_cast<real>(g) / static_cast<real>(mGuide.size());
+      while (mStarts[j + 1] <= u) {
+        ++j;
+      }
+      mGuide[g] = j;
+    }
+  }
+
+  real u_resolution() const { return mUResolution; }
+
+  // Number of intervals in the table
+  std::size_t size() const { return mIntervals.size(); }
+
+  // Approximate quantile at u in (0, 1)
+  real inverse(const real u) const {
+    const auto cell = static_cast<std::size_t>(u * static_cast<real>(mGuide.size()));
+    std::size_t j = mGuide[std::min(cell, mGuide.size() - 1)];
+    while (u >= mStarts[j + 1]) {
+      ++j;
+    }
+    const Interval &interval = mIntervals[j];
+    return interval(std::min(std::max(u - interval.u_start, real{0.0}), interval.width));
+  }
+
+  template <class Engine> real operator()(Engine &engine) const {
+    return inverse(uniform_open<real>(engine));
+  }
+
+  // Draws all the uniforms first, so that the inversion runs as a separate loop free of engine
+  // calls
+  template <class Engine> void fill(Engine &engine, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = uniform_open<real>(engine);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = inverse(out[i]);
+    }
+  }
+};
+
+// Beta sampler choosing, from the parameters, between Jöhnk's method (both parameters below one)
+// and Cheng's (1978) algorithms BB (both above one) and BC (otherwise), following the layout of R's
+// rbeta. Each draw costs two uniforms per attempt, with no gamma variates.
+template <class real> class BetaSampler {
+public:
+  enum class Method { Johnk, ChengBB, ChengBC };
+
+private:
+  Method mMethod;
+
+  // Whether alpha is the larger parameter, which decides how a draw is mapped back
+  bool mSwap;
+
+  // a = min(alpha, beta), b = max(alpha, beta) and Cheng's per-parameter constants
+  real mA;
+  real mB;
+  real mSum;
+  real mChengBeta;
+  real mChengGamma;
+  real mK1;
+  real mK2;
+
+  // 1 / alpha, 1 / beta for Jöhnk
+  real m1OnAlpha;
+  real m1OnBeta;
+
+  static constexpr real log4 = real{1.3862943611198906188L};
+  static constexpr real one_plus_log5 = real{2.6094379124341003746L};
+
+  // w = scale * e^v, saturating rather than overflowing
+  static real w_from_v(const real v, const real scale) {
+    const real w = scale * std::exp(v);
+    return std::isinf(w) ? std::numeric_limits<real>::max() : w;
+  }
+
+  template <class Engine> real johnk(Engine &engine) const {
+    // Accept X = U^(1/alpha), Y = V^(1/beta) when X + Y <= 1, working in logs so that small
+    // parameters do not underflow
+    for (;;) {
+      real log_x = std::log(uniform_open<real>(engine)) * m1OnAlpha;
+      real log_y = std::log(uniform_open<real>(engine)) * m1OnBeta;
+      const real log_m = std::max(log_x, log_y);
+      log_x -= log_m;
+      log_y -= log_m;
+      const real sum = std::exp(log_x) + std::exp(log_y);
+      if (log_m + std::log(sum) <= real{0.0}) {
+        return std::exp(log_x) / sum;
+      }
+    }
+  }
+
+  template <class Engine> real cheng_bb(Engine &engine) const {
+    real w;
+    real r;
+    real t;
+    do {
+      const real u1 = uniform_open<real>(engine);
+      const real u2 = uniform_open<real>(engine);
+      const real v = mChengBeta * std::log(u1 / (real{1.0} - u1));
+      w = w_from_v(v, mA);
+
+      const real z = u1 * u1 * u2;
+      r = mChengGamma * v - log4;
+      const real s = mA + r - w;
+      if (s + one_plus_log5 >= real{5.0} * z) {
+        break;
+      }
+      t = std::log(z);
+      if (s > t) {
+        break;
+      }
+    } while (r + mSum * std::log(mSum / (mB + w)) < t);
+
+    return mSwap ? mB / (mB + w) : w / (mB + w);
+  }
+
+  template <class Engine> real cheng_bc(Engine &engine) const {
+    real w;
+    for (;;) {
+      const real u1 = uniform_open<real>(engine);
+      const real u2 = uniform_open<real>(engine);
+      real z;
+      if (u1 < real{0.5}) {
+        const real y = u1 * u2;
+        z = u1 * y;
+        if (real{0.25} * u2 + z - y >= mK1) {
+          continue;
+        }
+      } else {
+        z = u1 * u1 * u2;
+        if (z <= real{0.25}) {
+          w = w_from_v(mChengBeta * std::log(u1 / (real{1.0} - u1)), mB);
+          break;
+        }
+        if (z >= mK2) {
+          continue;
+        }
+      }
+
+      const real v = mChengBeta * std::log(u1 / (real{1.0} - u1));
+      w = w_from_v(v, mB);
+      if (mSum * (std::log(mSum / (mA + w)) + v) - log4 >= std::log(z)) {
+        break;
+      }
+    }
+
+    return mSwap ? w / (mA + w) : mA / (mA + w);
+  }
+
+public:
+  BetaSampler(const real alpha, const real beta)
+      : mSwap(alpha > beta), mA(std::min(alpha, beta)), mB(std::max(alpha, beta)),
+        mSum(alpha + beta), m1OnAlpha(real{1.0} / alpha), m1OnBeta(real{1.0} / beta) {
+
+    if (mB < real{1.0}) {
+      mMethod = Method::Johnk;
+      mChengBeta = mChengGamma = mK1 = mK2 = real{0.0};
+    } else if (mA > real{1.0}) {
+      mMethod = Method::ChengBB;
+      mChengBeta = std::sqrt((mSum - real{2.0}) / (real{2.0} * mA * mB - mSum));
+      mChengGamma = mA + real{1.0} / mChengBeta;
+      mK1 = mK2 = real{0.0};
+    } else {
+      mMethod = Method::ChengBC;
+      mChengBeta = real{1.0} / mA;
+      mChengGamma = real{0.0};
+      const real delta = real{1.0} + mB - mA;
+      mK1 = delta * (real{0.0138889} + real{0.0416667} * mA) / (mB * mChengBeta - real{0.777778});
+      mK2 = real{0.25} + (real{0.5} + real{0.25} / delta) * mA;
+    }
+  }
+
+  Method method() const { return mMethod; }
+
+  template <class Engine> real operator()(Engine &engine) const {
+    switch (mMethod) {
+    case Method::Johnk:
+      return johnk(engine);
+    case Method::ChengBB:
+      return cheng_bb(engine);
+    case Method::ChengBC:
+      break;
+    }
+    return cheng_bc(engine);
+  }
+};
+
+template <class real> class StaticBeta : public StaticContinuousUnivariate<StaticBeta<real>, real> {
 private:
   // Params
   real mAlpha;
   real mBeta;
 
-  // Dists
-  std::gamma_distribution<real> mDistX;
-  std::gamma_distribution<real> mDistY;
-
   // Cached constants for Pdf & LogPdf
   real m1OnBetaFn;
   real mLogBetaFn;
-  real mAm1;
-  real mBm1;
 
-public:
-  explicit Beta(const real alpha = 1.0, const real beta = 1.0) : mAlpha(alpha), mBeta(beta) {
+  void cache_constants() {
 
     // Both params must be positive
     assert(mAlpha > real{0.0});
     assert(mBeta > real{0.0});
 
-    mDistX = std::gamma_distribution<real>{mAlpha, real{1.0}};
-    mDistY = std::gamma_distribution<real>{mBeta, real{1.0}};
-
-    // Constants for Beta function evaluations
-    m1OnBetaFn = std::tgamma(mAlpha + mBeta) / (std::tgamma(mAlpha) * std::tgamma(mBeta));
+    // Constants for Beta function evaluations. The reciprocal is taken from the log rather than
+    // from three tgamma calls, which also keeps it finite where those overflow.
     mLogBetaFn = std::lgamma(mAlpha + mBeta) - (std::lgamma(mAlpha) + std::lgamma(mBeta));
+    m1OnBetaFn = std::exp(mLogBetaFn);
+  }
+
+public:
+  explicit StaticBeta(const real alpha = 1.0, const real beta = 1.0)
+      : mAlpha(alpha), mBeta(beta) {
+    cache_constants();
+  }
+
+  real alpha() const { return mAlpha; }
+  real beta() const { return mBeta; }
 
-    // Other useful constants
-    mAm1 = mAlpha - real{1.0};
-    mBm1 = mBeta - real{1.0};
+  // Changes the parameters in place, recomputing only the cached constants
+  void set_params(const real alpha, const real beta) {
+    mAlpha = alpha;
+    mBeta = beta;
+    cache_constants();
   }
 
-  real pdf(const real x) override {
+  real pdf(const real x) const {
     if (x > real{0.0} && x < real{1.0}) {
-      return std::pow(x, mAm1) * std::pow(real{1.0} - x, mBm1) * m1OnBetaFn;
+      return std::pow(x, mAlpha - real{1.0}) * std::pow(real{1.0} - x, mBeta - real{1.0}) *
+             m1OnBetaFn;
     } else {
       return real{0.0};
     }
   }
 
-  real log_pdf(const real x) override {
+  real log_pdf(const real x) const {
     if (x > real{0.0} && x < real{1.0}) {
-      return mAm1 * std::log(x) + mBm1 * std::log1p(-x) + mLogBetaFn;
+      return (mAlpha - real{1.0}) * std::log(x) + (mBeta - real{1.0}) * std::log1p(-x) +
+             mLogBetaFn;
     } else {
       return -std::numeric_limits<real>::infinity();
     }
   }
 
+  void pdf(const real *x, real *out, const std::size_t n) const {
+    simd::beta_pdf(x, out, n, mAlpha - real{1.0}, mBeta - real{1.0}, mLogBetaFn);
+  }
+
+  void log_pdf(const real *x, real *out, const std::size_t n) const {
+    simd::beta_log_pdf(x, out, n, mAlpha - real{1.0}, mBeta - real{1.0}, mLogBetaFn);
+  }
+
+  real cdf(const real x) const {
+    return regularized_incomplete_beta(mAlpha, mBeta, mLogBetaFn, x);
+  }
+  // Assembled in log space, so it stays finite far below where cdf underflows
+  real log_cdf(const real x) const {
+    return log_regularized_incomplete_beta(IncompleteBetaTerms<real>{mAlpha, mBeta},
+                                           IncompleteBetaTerms<real>{mBeta, mAlpha}, mLogBetaFn, x);
+  }
+
+  // Evaluated directly rather than as 1 - cdf, which keeps its precision as x approaches 1
+  real survival(const real x) const {
+    return regularized_incomplete_beta(IncompleteBetaTerms<real>{mAlpha, mBeta},
+                                       IncompleteBetaTerms<real>{mBeta, mAlpha}, mLogBetaFn, x,
+                                       true);
+  }
+
+  real quantile(const real p) const { return incomplete_beta().inverse(p); }
+
+  // The batch forms share one IncompleteBeta across all points
+  void cdf(const real *x, real *out, const std::size_t n) const { incomplete_beta()(x, out, n); }
+
+  void log_cdf(const real *x, real *out, const std::size_t n) const {
+    incomplete_beta().log(x, out, n);
+  }
+
+  void survival(const real *x, real *out, const std::size_t n) const {
+    incomplete_beta().complement(x, out, n);
+  }
+
+  void quantile(const real *p, real *out, const std::size_t n) const {
+    const IncompleteBeta<real> fn = incomplete_beta();
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = fn.inverse(p[i]);
+    }
+  }
+
+  // Evaluator for the cdf, I_x(alpha, beta), built from the cached constants
+  IncompleteBeta<real> incomplete_beta() const {
+    return IncompleteBeta<real>{mAlpha, mBeta, mLogBetaFn};
+  }
+
+  // The sampler is not stored, to keep this type small; it is set up per call to rand or fill
+  BetaSampler<real> sampler() const { return BetaSampler<real>{mAlpha, mBeta}; }
+
+  template <class Engine> real rand(Engine &engine) const { return sampler()(engine); }
+
+  template <class Engine> void fill(Engine &engine, real *out, const std::size_t n) const {
+    const BetaSampler<real> beta_sampler = sampler();
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = beta_sampler(engine);
+    }
+  }
+};
+
+template <class real, class Engine = std::mt19937>
+class Beta : public ContinuousUnivariateAdapter<StaticBeta<real>, Engine> {
+private:
+  using Adapter = ContinuousUnivariateAdapter<StaticBeta<real>, Engine>;
+
+  // Sampler, chosen from the parameters and kept for repeated single draws
+  BetaSampler<real> mSampler;
+
+  // Table for inverse-cdf sampling, used in place of mSampler once built
+  std::optional<InverseCdfSampler<real>> mInverseCdf;
+
+public:
+  explicit Beta(const real alpha = 1.0, const real beta = 1.0)
+      : Adapter(StaticBeta<real>{alpha, beta}), mSampler(alpha, beta) {}
+
+  Beta(const real alpha, const real beta, Engine engine)
+      : Adapter(StaticBeta<real>{alpha, beta}, std::move(engine)), mSampler(alpha, beta) {}
+
+  Beta(const real alpha, const real beta, const std::uint64_t seed)
+      : Adapter(StaticBeta<real>{alpha, beta}, seed), mSampler(alpha, beta) {}
+
   real rand() override {
-    const real x = mDistX(this->mMt);
-    const real y = mDistY(this->mMt);
-    return x / (x + y);
+    return mInverseCdf ? (*mInverseCdf)(this->mEngine) : mSampler(this->mEngine);
+  }
+
+  void fill(real *out, const std::size_t n) override { Beta::fill(this->mEngine, out, n); }
+
+  void fill(Engine &engine, real *out, const std::size_t n) const override {
+    if (mInverseCdf) {
+      mInverseCdf->fill(engine, out, n);
+      return;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = mSampler(engine);
+    }
+  }
+
+  const BetaSampler<real> &sampler() const { return mSampler; }
+
+  // Switches rand and fill to inverse-cdf sampling through a table built here to the given
+  // u-resolution, which pays for itself when many values are drawn with the same parameters
+  void use_inverse_cdf(const real u_resolution) {
+    mInverseCdf.emplace(this->distribution(), u_resolution);
+  }
+
+  // Switches back to the rejection sampler
+  void use_rejection() { mInverseCdf.reset(); }
+
+  bool uses_inverse_cdf() const { return mInverseCdf.has_value(); }
+
+  // Changes the parameters in place, keeping the engine and its state and the sampling mode. In
+  // inverse-cdf mode this rebuilds the table.
+  void set_params(const real alpha, const real beta) {
+    this->mDist.set_params(alpha, beta);
+    mSampler = BetaSampler<real>{alpha, beta};
+    if (mInverseCdf) {
+      const real u_resolution = mInverseCdf->u_resolution();
+      mInverseCdf.emplace(this->mDist, u_resolution);
+    }
+  }
+};
+
+// Standard normal sampler using the 256-layer ziggurat of Marsaglia & Tsang (2000), in the form
+// given by Doornik (2005), "An improved ziggurat method to generate normal random samples". Most
+// draws cost one engine call, a table lookup and a multiply.
+template <class real> class NormalZiggurat {
+private:
+  static constexpr int layers = 256;
+
+  struct Tables {
+    real r;
+    real x[layers + 1];
+    real ratio[layers];
+  };
+
+  static Tables build_tables() {
+    using hp = long double;
+    const hp r = 3.6541528853610088L;
+    const hp f_r = std::exp(hp{-0.5} * r * r);
+    const hp v = r * f_r + std::sqrt(zoo::pi<hp> / hp{2.0}) * std::erfc(r / std::sqrt(hp{2.0}));
+
+    hp x[layers + 1];
+    x[0] = v / f_r;
+    x[1] = r;
+    x[layers] = hp{0.0};
+
+    hp f = f_r;
+    for (int i = 2; i < layers; ++i) {
+      x[i] = std::sqrt(std::max(hp{0.0}, hp{-2.0} * std::log(v / x[i - 1] + f)));
+      f = std::exp(hp{-0.5} * x[i] * x[i]);
+    }
+
+    Tables tables{};
+    tables.r = static_cast<real>(r);
+    for (int i = 0; i <= layers; ++i) {
+      tables.x[i] = static_cast<real>(x[i]);
+    }
+    for (int i = 0; i < layers; ++i) {
+      tables.ratio[i] = static_cast<real>(x[i + 1] / x[i]);
+    }
+    return tables;
+  }
+
+  template <class Engine> static real tail(const Tables &t, Engine &engine, const bool negative) {
+    real x;
+    real y;
+    do {
+      x = -std::log(uniform_open<real>(engine)) / t.r;
+      y = -std::log(uniform_open<real>(engine));
+    } while (y + y < x * x);
+    return negative ? -(t.r + x) : t.r + x;
+  }
+
+public:
+  // Built once per precision, on first use.
+  static const Tables &tables() {
+    static const Tables t = build_tables();
+    return t;
+  }
+
+  template <class Engine> static real sample(const Tables &t, Engine &engine) {
+    for (;;) {
+      // The top 8 bits pick the layer and the bits below them give u on (-1, 1). Float needs
+      // few enough bits that a single 32-bit draw suffices.
+      std::uint64_t bits;
+      if constexpr (uniform_bits<real> + 8 <= 32) {
+        bits = std::uint64_t{random_bits32(engine)} << 32u;
+      } else {
+        bits = random_bits64(engine);
+      }
+      const auto i = static_cast<int>(bits >> 56u);
+      const real u = real{2.0} * uniform_open_from_bits<real>(bits << 8u) - real{1.0};
+
+      if (std::fabs(u) < t.ratio[i]) {
+        return u * t.x[i];
+      }
+      if (i == 0) {
+        return tail(t, engine, u < real{0.0});
+      }
+
+      const real x = u * t.x[i];
+      const real f0 = std::exp(real{-0.5} * (t.x[i] * t.x[i] - x * x));
+      const real f1 = std::exp(real{-0.5} * (t.x[i + 1] * t.x[i + 1] - x * x));
+      if (f1 + uniform_open<real>(engine) * (f0 - f1) < real{1.0}) {
+        return x;
+      }
+    }
   }
+
+  template <class Engine> static real sample(Engine &engine) { return sample(tables(), engine); }
 };
 
-template <class real> class Normal : public ContinuousUnivariate<real> {
+template <class real>
+class StaticNormal : public StaticContinuousUnivariate<StaticNormal<real>, real> {
 private:
   // Params
   real mMean;
   real mStdDev;
 
-  // Dist
-  std::normal_distribution<real> mDist;
-
   // Cached constants for Pdf & LogPdf
-  real m2SigSq;
+  real m1On2SigSq;
   real mPrefactor;
   real mLogPrefactor;
 
-public:
-  explicit Normal(const real mean = 0.0, const real std_dev = 1.0) : mMean(mean), mStdDev(std_dev) {
+  void cache_constants() {
 
     // Standard deviation must be positive
     assert(mStdDev > real{0.0});
 
-    mDist = std::normal_distribution<real>{mMean, mStdDev};
+    const real two_sig_sq = real{2.0} * mStdDev * mStdDev;
+    m1On2SigSq = real{1.0} / two_sig_sq;
+    mPrefactor = real{1.0} / std::sqrt(zoo::pi<real> * two_sig_sq);
+    mLogPrefactor = real{-0.5} * std::log(zoo::pi<real> * two_sig_sq);
+  }
+
+public:
+  explicit StaticNormal(const real mean = 0.0, const real std_dev = 1.0)
+      : mMean(mean), mStdDev(std_dev) {
+    cache_constants();
+  }
 
-    m2SigSq = real{2.0} * mStdDev * mStdDev;
-    mPrefactor = real{1.0} / std::sqrt(zoo::pi<real> * m2SigSq);
-    mLogPrefactor = real{-0.5} * std::log(zoo::pi<real> * m2SigSq);
+  real mean() const { return mMean; }
+  real std_dev() const { return mStdDev; }
+
+  // Changes the parameters in place, recomputing only the cached constants
+  void set_params(const real mean, const real std_dev) {
+    mMean = mean;
+    mStdDev = std_dev;
+    cache_constants();
   }
 
-  real pdf(const real x) override {
-    return mPrefactor * std::exp(-(x - mMean) * (x - mMean) / m2SigSq);
+  real pdf(const real x) const {
+    return mPrefactor * std::exp(-(x - mMean) * (x - mMean) * m1On2SigSq);
   }
 
-  real log_pdf(const real x) override {
-    return mLogPrefactor - (x - mMean) * (x - mMean) / m2SigSq;
+  real log_pdf(const real x) const {
+    return mLogPrefactor - (x - mMean) * (x - mMean) * m1On2SigSq;
   }
 
-  real rand() override { return mDist(this->mMt); }
+  void pdf(const real *x, real *out, const std::size_t n) const {
+    simd::normal_pdf(x, out, n, mMean, m1On2SigSq, mPrefactor);
+  }
+
+  void log_pdf(const real *x, real *out, const std::size_t n) const {
+    simd::normal_log_pdf(x, out, n, mMean, m1On2SigSq, mLogPrefactor);
+  }
+
+  real cdf(const real x) const {
+    return real{0.5} * std::erfc((mMean - x) / mStdDev * inv_sqrt2<real>);
+  }
+
+  real log_cdf(const real x) const { return standard_normal_log_cdf((x - mMean) / mStdDev); }
+
+  real survival(const real x) const {
+    return real{0.5} * std::erfc((x - mMean) / mStdDev * inv_sqrt2<real>);
+  }
+
+  real quantile(const real p) const { return mMean + mStdDev * standard_normal_quantile(p); }
+
+  void cdf(const real *x, real *out, const std::size_t n) const {
+    simd::half_erfc(x, out, n, mMean, -inv_sqrt2<real> / mStdDev);
+  }
+
+  void log_cdf(const real *x, real *out, const std::size_t n) const {
+    simd::normal_log_cdf(x, out, n, mMean, -inv_sqrt2<real> / mStdDev);
+  }
+
+  void survival(const real *x, real *out, const std::size_t n) const {
+    simd::half_erfc(x, out, n, mMean, inv_sqrt2<real> / mStdDev);
+  }
+
+  void quantile(const real *p, real *out, const std::size_t n) const {
+    simd::normal_quantile(p, out, n, mMean, mStdDev);
+  }
+
+  template <class Engine> real rand(Engine &engine) const {
+    return mMean + mStdDev * NormalZiggurat<real>::sample(engine);
+  }
+
+  template <class Engine> void fill(Engine &engine, real *out, const std::size_t n) const {
+    const auto &tables = NormalZiggurat<real>::tables();
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = mMean + mStdDev * NormalZiggurat<real>::sample(tables, engine);
+    }
+  }
+};
+
+template <class real, class Engine = std::mt19937>
+class Normal : public ContinuousUnivariateAdapter<StaticNormal<real>, Engine> {
+private:
+  using Adapter = ContinuousUnivariateAdapter<StaticNormal<real>, Engine>;
+
+public:
+  explicit Normal(const real mean = 0.0, const real std_dev = 1.0)
+      : Adapter(StaticNormal<real>{mean, std_dev}) {}
+
+  Normal(const real mean, const real std_dev, Engine engine)
+      : Adapter(StaticNormal<real>{mean, std_dev}, std::move(engine)) {}
+
+  Normal(const real mean, const real std_dev, const std::uint64_t seed)
+      : Adapter(StaticNormal<real>{mean, std_dev}, seed) {}
+
+  // Changes the parameters in place, keeping the engine and its state
+  void set_params(const real mean, const real std_dev) { this->mDist.set_params(mean, std_dev); }
 };
 
+// Piecewise Chebyshev approximation of a function on [lo, hi]. Pieces are bisected until the
+// error of a degree-seven series, measured between its nodes, is within an absolute tolerance,
+// so they are short only where the function needs it. The piece for x is found through a guide
+// table, and evaluation is Clenshaw's recurrence: a handful of multiply-adds.
+template <class real> class PiecewiseChebyshev {
+private:
+  static constexpr int degree = 7;
+  static constexpr int nodes = degree + 1;
+
+  // Bisection depth at which a piece is kept whatever its error, as next to a singularity
+  static constexpr int max_depth = 40;
+
+  // f(x) ~ sum_k coeffs[k] T_k(y) with y = (x - mid) * inv_half_width
+  struct Piece {
+    real mid;
+    real inv_half_width;
+    real coeffs[nodes];
+
+    real operator()(const real x) const {
+      const real y = (x - mid) * inv_half_width;
+      real b1{0.0};
+      real b2{0.0};
+      for (int k = degree; k > 0; --k) {
+        const real b0 = real{2.0} * y * b1 - b2 + coeffs[k];
+        b2 = b1;
+        b1 = b0;
+      }
+      return y * b1 - b2 + coeffs[0];
+    }
+  };
+
+  std::vector<Piece> mPieces;
+
+  // Left ends of the pieces, followed by an infinite sentinel
+  std::vector<real> mStarts;
+
+  // mGuide[g] is the piece containing lo + g (hi - lo) / mGuide.size()
+  std::vector<std::size_t> mGuide;
+
+  real mLo;
+  real mGuideScale;
+  real mError{0.0};
+
+  template <class F>
+  void fit(const F &f, const real a, const real b, const real tolerance, const int depth) {
+    Piece piece;
+    piece.mid = real{0.5} * (a + b);
+    piece.inv_half_width = real{2.0} / (b - a);
+
+    // Interpolate at the Chebyshev points of the first kind, which avoid the ends
+    real values[nodes];
+    for (int j = 0; j < nodes; ++j) {
+      const real y = std::cos(pi<real> * (real(j) + real{0.5}) / real(nodes));
+      values[j] = f(piece.mid + y / piece.inv_half_width);
+    }
+    for (int k = 0; k < nodes; ++k) {
+      real sum{0.0};
+      for (int j = 0; j < nodes; ++j) {
+        sum += values[j] * std::cos(pi<real> * real(k) * (real(j) + real{0.5}) / real(nodes));
+      }
+      piece.coeffs[k] = (k == 0 ? real{1.0} : real{2.0}) * sum / real(nodes);
+    }
+
+    // Error at points between the nodes. Where f changes by more than the tolerance between
+    // representable x, as log_pdf does next to a zero of the pdf, no piece can meet it; the
+    // tolerance is widened there by the change of f over a few ulps.
+    const real spacing = (b - a) / real(2 * nodes);
+    real error{0.0};
+    real slope{0.0};
+    real previous{0.0};
+    for (int j = 0; j < 2 * nodes; ++j) {
+      const real x = a + spacing * (real(j) + real{0.5});
+      const real value = f(x);
+      const real difference = std::fabs(piece(x) - value);
+      error = difference > error || std::isnan(difference) ? difference : error;
+      slope = j > 0 ? std::max(slope, std::fabs(value - previous) / spacing) : slope;
+      previous = value;
+    }
+    const real ulp_change = slope * real{4.0} * std::numeric_limits<real>::epsilon() *
+                            std::max(std::fabs(a), std::fabs(b));
+
+    const real mid = piece.mid;
+    if (!(error > tolerance + ulp_change) || depth == max_depth || !(a < mid && mid < b)) {
+      mPieces.push_back(piece);
+      mStarts.push_back(a);
+      mError = error > mError || std::isnan(error) ? error : mError;
+      return;
+    }
+    fit(f, a, mid, tolerance, depth + 1);
+    fit(f, mid, b, tolerance, depth + 1);
+  }
+
+public:
+  template <class F>
+  PiecewiseChebyshev(const F &f, const real lo, const real hi, const real tolerance) : mLo(lo) {
+    assert(lo < hi);
+    assert(tolerance > real{0.0});
+
+    fit(f, lo, hi, tolerance, 0);
+    mStarts.push_back(std::numeric_limits<real>::infinity());
+
+    mGuide.resize(4 * mPieces.size());
+    mGuideScale = static_cast<real>(mGuide.size()) / (hi - lo);
+    std::size_t j = 0;
+    for (std::size_t g = 0; g < mGuide.size(); ++g) {
+      const real x = lo + static_cast<real>(g) / mGuideScale;
+      while (mStarts[j + 1] <= x) {
+        ++j;
+      }
+      mGuide[g] = j;
+    }
+  }
+
+  // Largest error measured while fitting. It exceeds the tolerance only where rounding of x, or
+  // a singularity that bisection cannot isolate, prevents meeting it.
+  real error() const { return mError; }
+
+  // Number of pieces
+  std::size_t size() const { return mPieces.size(); }
+
+  // Approximation at x in [lo, hi]
+  real operator()(const real x) const {
+    const auto cell = static_cast<std::size_t>((x - mLo) * mGuideScale);
+    std::size_t j = mGuide[std::min(cell, mGuide.size() - 1)];
+    while (x >= mStarts[j + 1]) {
+      ++j;
+    }
+    return mPieces[j](x);
+  }
+};
+
+// Static distribution evaluating the pdf and log_pdf of Dist on [lo, hi] from piecewise
+// Chebyshev approximations built at construction, so that calls there involve no transcendental
+// functions. The pdf is fitted to within tolerance times its largest value on a grid over the
+// domain, and log_pdf to within tolerance absolutely. Points outside [lo, hi], and every other
+// method, go to Dist itself.
+template <class Dist>
+class ApproximatePdf
+    : public StaticContinuousUnivariate<ApproximatePdf<Dist>, typename Dist::real_type> {
+public:
+  using real = typename Dist::real_type;
+
+private:
+  using Base = StaticContinuousUnivariate<ApproximatePdf<Dist>, real>;
+
+  Dist mDist;
+  real mLo;
+  real mHi;
+  PiecewiseChebyshev<real> mPdf;
+  PiecewiseChebyshev<real> mLogPdf;
+
+  static real peak_pdf(const Dist &dist, const real lo, const real hi) {
+    constexpr int points = 1024;
+    real peak{0.0};
+    for (int i = 0; i < points; ++i) {
+      peak = std::max(peak, dist.pdf(lo + (hi - lo) * (real(i) + real{0.5}) / real(points)));
+    }
+    return peak;
+  }
+
+public:
+  ApproximatePdf(const Dist &dist, const real lo, const real hi, const real tolerance)
+      : mDist(dist), mLo(lo), mHi(hi),
+        mPdf([&](const real x) { return dist.pdf(x); }, lo, hi,
+             tolerance * peak_pdf(dist, lo, hi)),
+        mLogPdf([&](const real x) { return dist.log_pdf(x); }, lo, hi, tolerance) {}
+
+  const Dist &distribution() const { return mDist; }
+  real lo() const { return mLo; }
+  real hi() const { return mHi; }
+
+  // Largest errors measured while fitting, absolute for both
+  real pdf_error() const { return mPdf.error(); }
+  real log_pdf_error() const { return mLogPdf.error(); }
+
+  // The batch forms loop over the scalar ones
+  using Base::cdf;
+  using Base::log_cdf;
+  using Base::log_pdf;
+  using Base::pdf;
+  using Base::quantile;
+  using Base::survival;
+
+  // Clamped at zero, which the series can undershoot by up to the error near a zero of the pdf
+  real pdf(const real x) const {
+    return x >= mLo && x <= mHi ? std::max(real{0.0}, mPdf(x)) : mDist.pdf(x);
+  }
+
+  real log_pdf(const real x) const {
+    return x >= mLo && x <= mHi ? mLogPdf(x) : mDist.log_pdf(x);
+  }
+
+  real cdf(const real x) const { return mDist.cdf(x); }
+  real log_cdf(const real x) const { return mDist.log_cdf(x); }
+  real survival(const real x) const { return mDist.survival(x); }
+  real quantile(const real p) const { return mDist.quantile(p); }
+
+  template <class Engine> real rand(Engine &engine) const { return mDist.rand(engine); }
+
+  template <class Engine> void fill(Engine &engine, real *out, const std::size_t n) const {
+    mDist.fill(engine, out, n);
+  }
+};
+
+// A closed set of static distributions of mixed type, e.g. the priors of a model. Entries are
+// stored in one contiguous vector per type, so evaluating the set runs a homogeneous, inlined
+// loop per type instead of a pointer chase and a virtual call per entry. Entry i keeps its
+// position: point x[i] is evaluated against it and result out[i] is written for it.
+template <class... Dists> class DistributionSet {
+public:
+  using value_type = std::variant<Dists...>;
+  using real = typename std::tuple_element_t<0, std::tuple<Dists...>>::real_type;
+
+  static_assert((std::is_same_v<typename Dists::real_type, real> && ...),
+                "All distributions in a DistributionSet must share a real type");
+
+private:
+  static constexpr std::size_t n_types = sizeof...(Dists);
+
+  template <class Dist> static constexpr std::size_t type_index() {
+    constexpr bool matches[] = {std::is_same_v<Dist, Dists>...};
+    for (std::size_t t = 0; t < n_types; ++t) {
+      if (matches[t]) {
+        return t;
+      }
+    }
+    return n_types;
+  }
+
+  // Where entry i lives: the vector for its type, and its position there
+  struct Slot {
+    std::size_t type;
+    std::size_t pos;
+  };
+
+  std::tuple<std::vector<Dists>...> mDists;
+  std::array<std::vector<std::size_t>, n_types> mIndices;
+  std::vector<Slot> mSlots;
+
+  template <class F, std::size_t... T>
+  void for_each_type(F &&f, std::index_sequence<T...> /*types*/) const {
+    (f(std::get<T>(mDists), mIndices[T]), ...);
+  }
+
+  template <class F> void for_each_type(F &&f) const {
+    for_each_type(std::forward<F>(f), std::index_sequence_for<Dists...>{});
+  }
+
+  template <std::size_t T> value_type make_variant(const Slot slot) const {
+    if constexpr (T + 1 < n_types) {
+      if (slot.type != T) {
+        return make_variant<T + 1>(slot);
+      }
+    }
+    return value_type{std::in_place_index<T>, std::get<T>(mDists)[slot.pos]};
+  }
+
+public:
+  // Append a distribution and return its index in the set
+  template <class Dist> std::size_t push_back(const Dist &dist) {
+    constexpr std::size_t t = type_index<Dist>();
+    static_assert(t < n_types, "Distribution type is not part of this DistributionSet");
+
+    auto &dists = std::get<t>(mDists);
+    mSlots.push_back(Slot{t, dists.size()});
+    mIndices[t].push_back(mSlots.size() - 1);
+    dists.push_back(dist);
+    return mSlots.size() - 1;
+  }
+
+  std::size_t push_back(const value_type &dist) {
+    return std::visit([this](const auto &d) { return this->push_back(d); }, dist);
+  }
+
+  std::size_t size() const { return mSlots.size(); }
+  bool empty() const { return mSlots.empty(); }
+
+  // A copy of entry i
+  value_type operator[](const std::size_t i) const {
+    assert(i < size());
+    return make_variant<0>(mSlots[i]);
+  }
+
+  // All entries of one type, contiguous, in the order they were added
+  template <class Dist> const std::vector<Dist> &entries() const {
+    return std::get<type_index<Dist>()>(mDists);
+  }
+
+  // out[i] = pdf of entry i at x[i], for every entry
+  void pdf(const real *x, real *out) const {
+    for_each_type([x, out](const auto &dists, const std::vector<std::size_t> &indices) {
+      for (std::size_t k = 0; k < dists.size(); ++k) {
+        out[indices[k]] = dists[k].pdf(x[indices[k]]);
+      }
+    });
+  }
+
+  // out[i] = log_pdf of entry i at x[i], for every entry
+  void log_pdf(const real *x, real *out) const {
+    for_each_type([x, out](const auto &dists, const std::vector<std::size_t> &indices) {
+      for (std::size_t k = 0; k < dists.size(); ++k) {
+        out[indices[k]] = dists[k].log_pdf(x[indices[k]]);
+      }
+    });
+  }
+
+  // Sum over entries of log_pdf of entry i at x[i], e.g. the joint log prior
+  real log_pdf_sum(const real *x) const {
+    real sum{0.0};
+    for_each_type([x, &sum](const auto &dists, const std::vector<std::size_t> &indices) {
+      for (std::size_t k = 0; k < dists.size(); ++k) {
+        sum += dists[k].log_pdf(x[indices[k]]);
+      }
+    });
+    return sum;
+  }
+
+  // out[i] = a draw from entry i. Draws are taken type by type, so the sequence depends only on
+  // the engine and the contents of the set.
+  template <class Engine> void rand(Engine &engine, real *out) const {
+    for_each_type([&engine, out](const auto &dists, const std::vector<std::size_t> &indices) {
+      for (std::size_t k = 0; k < dists.size(); ++k) {
+        out[indices[k]] = dists[k].rand(engine);
+      }
+    });
+  }
+};
+
+// Many Normals with different parameters, stored as a structure of arrays: one contiguous column
+// per parameter and per cached constant. Evaluating entry i at x[i] (paired), or every entry at one
+// x (broadcast), runs a single vectorised pass over the columns.
+template <class real> class NormalBatch {
+private:
+  // Params
+  std::vector<real> mMean;
+  std::vector<real> mStdDev;
+
+  // Cached constants for Pdf & LogPdf
+  std::vector<real> m1On2SigSq;
+  std::vector<real> mLogPrefactor;
+
+  void cache_constants(const std::size_t i) {
+
+    // Standard deviation must be positive
+    assert(mStdDev[i] > real{0.0});
+
+    const real two_sig_sq = real{2.0} * mStdDev[i] * mStdDev[i];
+    m1On2SigSq[i] = real{1.0} / two_sig_sq;
+    mLogPrefactor[i] = real{-0.5} * std::log(zoo::pi<real> * two_sig_sq);
+  }
+
+public:
+  NormalBatch() = default;
+
+  NormalBatch(const real *mean, const real *std_dev, const std::size_t n) {
+    assign(mean, std_dev, n);
+  }
+
+  std::size_t size() const { return mMean.size(); }
+  bool empty() const { return mMean.empty(); }
+
+  void reserve(const std::size_t n) {
+    mMean.reserve(n);
+    mStdDev.reserve(n);
+    m1On2SigSq.reserve(n);
+    mLogPrefactor.reserve(n);
+  }
+
+  // Replace every entry, reusing the existing storage
+  void assign(const real *mean, const real *std_dev, const std::size_t n) {
+    mMean.assign(mean, mean + n);
+    mStdDev.assign(std_dev, std_dev + n);
+    m1On2SigSq.resize(n);
+    mLogPrefactor.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      cache_constants(i);
+    }
+  }
+
+  void push_back(const real mean, const real std_dev) {
+    mMean.push_back(mean);
+    mStdDev.push_back(std_dev);
+    m1On2SigSq.push_back(real{0.0});
+    mLogPrefactor.push_back(real{0.0});
+    cache_constants(size() - 1);
+  }
+
+  void set(const std::size_t i, const real mean, const real std_dev) {
+    assert(i < size());
+    mMean[i] = mean;
+    mStdDev[i] = std_dev;
+    cache_constants(i);
+  }
+
+  real mean(const std::size_t i) const { return mMean[i]; }
+  real std_dev(const std::size_t i) const { return mStdDev[i]; }
+
+  // Entry i as a standalone distribution
+  StaticNormal<real> operator[](const std::size_t i) const {
+    return StaticNormal<real>{mMean[i], mStdDev[i]};
+  }
+
+  // out[i] = pdf of entry i at x[i]
+  void pdf(const real *x, real *out) const {
+    simd::normal_pdf_columns(x, false, mMean.data(), m1On2SigSq.data(), mLogPrefactor.data(), out,
+                             size());
+  }
+
+  // out[i] = pdf of entry i at x
+  void pdf(const real x, real *out) const {
+    simd::normal_pdf_columns(&x, true, mMean.data(), m1On2SigSq.data(), mLogPrefactor.data(), out,
+                             size());
+  }
+
+  // out[i] = log_pdf of entry i at x[i]
+  void log_pdf(const real *x, real *out) const {
+    simd::normal_log_pdf_columns(x, false, mMean.data(), m1On2SigSq.data(), mLogPrefactor.data(),
+                                 out, size());
+  }
+
+  // out[i] = log_pdf of entry i at x
+  void log_pdf(const real x, real *out) const {
+    simd::normal_log_pdf_columns(&x, true, mMean.data(), m1On2SigSq.data(), mLogPrefactor.data(),
+                                 out, size());
+  }
+
+  // out[i] = a draw from entry i
+  template <class Engine> void rand(Engine &engine, real *out) const {
+    const auto &tables = NormalZiggurat<real>::tables();
+    for (std::size_t i = 0; i < size(); ++i) {
+      out[i] = mMean[i] + mStdDev[i] * NormalZiggurat<real>::sample(tables, engine);
+    }
+  }
+};
+
+// Many Betas with different parameters, stored as a structure of arrays; see NormalBatch.
+template <class real> class BetaBatch {
+private:
+  // Params
+  std::vector<real> mAlpha;
+  std::vector<real> mBeta;
+
+  // Cached constants for LogPdf
+  std::vector<real> mLogBetaFn;
+
+  void cache_constants(const std::size_t i) {
+
+    // Both params must be positive
+    assert(mAlpha[i] > real{0.0});
+    assert(mBeta[i] > real{0.0});
+
+    mLogBetaFn[i] =
+        std::lgamma(mAlpha[i] + mBeta[i]) - (std::lgamma(mAlpha[i]) + std::lgamma(mBeta[i]));
+  }
+
+public:
+  BetaBatch() = default;
+
+  BetaBatch(const real *alpha, const real *beta, const std::size_t n) { assign(alpha, beta, n); }
+
+  std::size_t size() const { return mAlpha.size(); }
+  bool empty() const { return mAlpha.empty(); }
+
+  void reserve(const std::size_t n) {
+    mAlpha.reserve(n);
+    mBeta.reserve(n);
+    mLogBetaFn.reserve(n);
+  }
+
+  // Replace every entry, reusing the existing storage
+  void assign(const real *alpha, const real *beta, const std::size_t n) {
+    mAlpha.assign(alpha, alpha + n);
+    mBeta.assign(beta, beta + n);
+    mLogBetaFn.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      cache_constants(i);
+    }
+  }
+
+  void push_back(const real alpha, const real beta) {
+    mAlpha.push_back(alpha);
+    mBeta.push_back(beta);
+    mLogBetaFn.push_back(real{0.0});
+    cache_constants(size() - 1);
+  }
+
+  void set(const std::size_t i, const real alpha, const real beta) {
+    assert(i < size());
+    mAlpha[i] = alpha;
+    mBeta[i] = beta;
+    cache_constants(i);
+  }
+
+  real alpha(const std::size_t i) const { return mAlpha[i]; }
+  real beta(const std::size_t i) const { return mBeta[i]; }
+
+  // Entry i as a standalone distribution
+  StaticBeta<real> operator[](const std::size_t i) const {
+    return StaticBeta<real>{mAlpha[i], mBeta[i]};
+  }
+
+  // out[i] = pdf of entry i at x[i]
+  void pdf(const real *x, real *out) const {
+    simd::beta_pdf_columns(x, false, mAlpha.data(), mBeta.data(), mLogBetaFn.data(), out, size());
+  }
+
+  // out[i] = pdf of entry i at x
+  void pdf(const real x, real *out) const {
+    simd::beta_pdf_columns(&x, true, mAlpha.data(), mBeta.data(), mLogBetaFn.data(), out, size());
+  }
+
+  // out[i] = log_pdf of entry i at x[i]
+  void log_pdf(const real *x, real *out) const {
+    simd::beta_log_pdf_columns(x, false, mAlpha.data(), mBeta.data(), mLogBetaFn.data(), out,
+                               size());
+  }
+
+  // out[i] = log_pdf of entry i at x
+  void log_pdf(const real x, real *out) const {
+    simd::beta_log_pdf_columns(&x, true, mAlpha.data(), mBeta.data(), mLogBetaFn.data(), out,
+                               size());
+  }
+
+  // out[i] = a draw from entry i
+  template <class Engine> void rand(Engine &engine, real *out) const {
+    for (std::size_t i = 0; i < size(); ++i) {
+      out[i] = BetaSampler<real>{mAlpha[i], mBeta[i]}(engine);
+    }
+  }
+};
+
+// Sum of x[0..n) by recursive halving, so rounding error grows as O(log n) rather than O(n).
+template <class real> real pairwise_sum(const real *x, const std::size_t n) {
+  if (n <= 16) {
+    real sum{0.0};
+    for (std::size_t i = 0; i < n; ++i) {
+      sum += x[i];
+    }
+    return sum;
+  }
+  const std::size_t half = n / 2;
+  return pairwise_sum(x, half) + pairwise_sum(x + half, n - half);
+}
+
+// Running sum with Neumaier's compensation, carrying the rounding error of each addition.
+template <class real> class CompensatedSum {
+private:
+  real mSum{0.0};
+  real mCompensation{0.0};
+
+public:
+  void add(const real x) {
+    const real t = mSum + x;
+    if (std::fabs(mSum) >= std::fabs(x)) {
+      mCompensation += (mSum - t) + x;
+    } else {
+      mCompensation += (x - t) + mSum;
+    }
+    mSum = t;
+  }
+
+  // Infinities and NaN in the sum make the compensation meaningless, so pass them straight through
+  real result() const { return std::isfinite(mSum) ? mSum + mCompensation : mSum; }
+};
+
+// Elements per block in log_likelihood. Each block is summed independently and the block sums are
+// then combined in order, so the result does not depend on the number of threads.
+constexpr std::size_t log_likelihood_block_size = std::size_t{1} << 14u;
+
+// Sum of dist.log_pdf over x[0..n), using up to n_threads threads. Points are evaluated through the
+// batch log_pdf into a small stack buffer, never a per-element vector, each buffer is summed
+// pairwise and the buffer sums are accumulated with compensation. Dist may be any distribution with
+// a batch log_pdf, virtual or static; with several threads that log_pdf is called concurrently.
+template <class Dist, class real>
+real log_likelihood(Dist &dist, const real *x, const std::size_t n, const unsigned n_threads = 1) {
+  constexpr std::size_t chunk_size = 256;
+  const std::size_t n_blocks = (n + log_likelihood_block_size - 1) / log_likelihood_block_size;
+  std::vector<real> block_sums(n_blocks);
+
+  std::atomic<std::size_t> next_block{0};
+  const auto worker = [&]() {
+    real buffer[chunk_size];
+    for (std::size_t b = next_block++; b < n_blocks; b = next_block++) {
+      const std::size_t first = b * log_likelihood_block_size;
+      const std::size_t last = std::min(n, first + log_likelihood_block_size);
+      CompensatedSum<real> sum;
+      for (std::size_t i = first; i < last; i += chunk_size) {
+        const std::size_t m = std::min(chunk_size, last - i);
+        dist.log_pdf(x + i, buffer, m);
+        sum.add(pairwise_sum(buffer, m));
+      }
+      block_sums[b] = sum.result();
+    }
+  };
+
+  const std::size_t n_workers =
+      std::clamp<std::size_t>(n_threads, 1, std::max<std::size_t>(n_blocks, 1));
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < n_workers; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  CompensatedSum<real> total;
+  for (const real block_sum : block_sums) {
+    total.add(block_sum);
+  }
+  return total.result();
+}
+
+template <class Dist, class real>
+real log_likelihood(Dist &dist, const std::vector<real> &x, const unsigned n_threads = 1) {
+  return log_likelihood(dist, x.data(), x.size(), n_threads);
+}
+
 } // namespace zoo
 
 #endif // CONTINUOUS_UNIVARIATE_HPP_
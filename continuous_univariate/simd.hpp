@@ -0,0 +1,516 @@
+/*
+MIT License
+
+Copyright (c) 2019 University of Oxford
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ZOO_SIMD_HPP_
+#define ZOO_SIMD_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "special_functions.hpp"
+
+// Hand-vectorised batch kernels for float and double with runtime dispatch. Every ISA is compiled
+// into the binary via target pragmas, and the widest one the CPU supports is chosen from CPUID on
+// first use. Other compilers and architectures, and long double, fall back to scalar loops.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ZOO_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(ZOO_SIMD_X86) && defined(__clang__)
+#define ZOO_SIMD_PUSH_SSE2                                                                         \
+  _Pragma("clang attribute push(__attribute__((target(\"sse2\"))), apply_to = function)")
+#define ZOO_SIMD_PUSH_AVX2                                                                         \
+  _Pragma("clang attribute push(__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+#define ZOO_SIMD_PUSH_AVX512                                                                       \
+  _Pragma("clang attribute push(__attribute__((target(\"avx512f\"))), apply_to = function)")
+#define ZOO_SIMD_POP _Pragma("clang attribute pop")
+#define ZOO_SIMD_POP_AVX512 ZOO_SIMD_POP
+#elif defined(ZOO_SIMD_X86)
+#define ZOO_SIMD_PUSH_SSE2 _Pragma("GCC push_options") _Pragma("GCC target(\"sse2\")")
+#define ZOO_SIMD_PUSH_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")")
+// GCC's AVX-512 headers seed some intrinsics with deliberately undefined vectors, which trips
+// -Wmaybe-uninitialized once they are inlined.
+#define ZOO_SIMD_PUSH_AVX512                                                                       \
+  _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f\")")                                 \
+      _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")       \
+          _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define ZOO_SIMD_POP_AVX512 _Pragma("GCC diagnostic pop") _Pragma("GCC pop_options")
+#define ZOO_SIMD_POP _Pragma("GCC pop_options")
+#endif
+
+namespace zoo::simd {
+
+enum class Isa { Scalar = 0, Sse2 = 1, Avx2 = 2, Avx512 = 3 };
+
+// The widest instruction set supported by this CPU, queried once.
+inline Isa detected_isa() {
+  static const Isa isa = [] {
+#ifdef ZOO_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return Isa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return Isa::Avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return Isa::Sse2;
+    }
+#endif
+    return Isa::Scalar;
+  }();
+  return isa;
+}
+
+inline std::atomic<int> &max_isa_storage() {
+  static std::atomic<int> max_isa{static_cast<int>(Isa::Avx512)};
+  return max_isa;
+}
+
+// Cap the instruction set used by the kernels, e.g. to compare code paths in tests or benchmarks.
+inline void set_max_isa(const Isa isa) {
+  max_isa_storage().store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+inline Isa active_isa() {
+  return static_cast<Isa>(std::min(static_cast<int>(detected_isa()),
+                                   max_isa_storage().load(std::memory_order_relaxed)));
+}
+
+template <class real>
+constexpr bool is_vectorised = std::is_same_v<real, float> || std::is_same_v<real, double>;
+
+} // namespace zoo::simd
+
+#ifdef ZOO_SIMD_X86
+
+ZOO_SIMD_PUSH_SSE2
+namespace zoo::simd::sse2 {
+
+template <class real> struct Vec;
+
+template <> struct Vec<double> {
+  using real = double;
+  using V = __m128d;
+  using M = __m128d;
+  static constexpr std::size_t width = 2;
+
+  static V set1(const real a) { return _mm_set1_pd(a); }
+  static V loadu(const real *p) { return _mm_loadu_pd(p); }
+  static void storeu(real *p, const V a) { _mm_storeu_pd(p, a); }
+  static V add(const V a, const V b) { return _mm_add_pd(a, b); }
+  static V sub(const V a, const V b) { return _mm_sub_pd(a, b); }
+  static V mul(const V a, const V b) { return _mm_mul_pd(a, b); }
+  static V div(const V a, const V b) { return _mm_div_pd(a, b); }
+  static V sqrt(const V a) { return _mm_sqrt_pd(a); }
+  static V fmadd(const V a, const V b, const V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+  static V min(const V a, const V b) { return _mm_min_pd(a, b); }
+  static V max(const V a, const V b) { return _mm_max_pd(a, b); }
+  static M lt(const V a, const V b) { return _mm_cmplt_pd(a, b); }
+  static M gt(const V a, const V b) { return _mm_cmpgt_pd(a, b); }
+  static M is_nan(const V a) { return _mm_cmpunord_pd(a, a); }
+  static M mask_and(const M a, const M b) { return _mm_and_pd(a, b); }
+  static V select(const M m, const V a, const V b) {
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+  }
+  static V bit_and(const V a, const V b) { return _mm_and_pd(a, b); }
+  static V bit_or(const V a, const V b) { return _mm_or_pd(a, b); }
+  static V shl_mantissa(const V a) {
+    return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a), 52));
+  }
+  static V shr_mantissa(const V a) {
+    return _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(a), 52));
+  }
+};
+
+template <> struct Vec<float> {
+  using real = float;
+  using V = __m128;
+  using M = __m128;
+  static constexpr std::size_t width = 4;
+
+  static V set1(const real a) { return _mm_set1_ps(a); }
+  static V loadu(const real *p) { return _mm_loadu_ps(p); }
+  static void storeu(real *p, const V a) { _mm_storeu_ps(p, a); }
+  static V add(const V a, const V b) { return _mm_add_ps(a, b); }
+  static V sub(const V a, const V b) { return _mm_sub_ps(a, b); }
+  static V mul(const V a, const V b) { return _mm_mul_ps(a, b); }
+  static V div(const V a, const V b) { return _mm_div_ps(a, b); }
+  static V sqrt(const V a) { return _mm_sqrt_ps(a); }
+  static V fmadd(const V a, const V b, const V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+  static V min(const V a, const V b) { return _mm_min_ps(a, b); }
+  static V max(const V a, const V b) { return _mm_max_ps(a, b); }
+  static M lt(const V a, const V b) { return _mm_cmplt_ps(a, b); }
+  static M gt(const V a, const V b) { return _mm_cmpgt_ps(a, b); }
+  static M is_nan(const V a) { return _mm_cmpunord_ps(a, a); }
+  static M mask_and(const M a, const M b) { return _mm_and_ps(a, b); }
+  static V select(const M m, const V a, const V b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+  }
+  static V bit_and(const V a, const V b) { return _mm_and_ps(a, b); }
+  static V bit_or(const V a, const V b) { return _mm_or_ps(a, b); }
+  static V shl_mantissa(const V a) {
+    return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(a), 23));
+  }
+  static V shr_mantissa(const V a) {
+    return _mm_castsi128_ps(_mm_srli_epi32(_mm_castps_si128(a), 23));
+  }
+};
+
+#include "simd_kernels.hpp"
+
+} // namespace zoo::simd::sse2
+ZOO_SIMD_POP
+
+ZOO_SIMD_PUSH_AVX2
+namespace zoo::simd::avx2 {
+
+template <class real> struct Vec;
+
+template <> struct Vec<double> {
+  using real = double;
+  using V = __m256d;
+  using M = __m256d;
+  static constexpr std::size_t width = 4;
+
+  static V set1(const real a) { return _mm256_set1_pd(a); }
+  static V loadu(const real *p) { return _mm256_loadu_pd(p); }
+  static void storeu(real *p, const V a) { _mm256_storeu_pd(p, a); }
+  static V add(const V a, const V b) { return _mm256_add_pd(a, b); }
+  static V sub(const V a, const V b) { return _mm256_sub_pd(a, b); }
+  static V mul(const V a, const V b) { return _mm256_mul_pd(a, b); }
+  static V div(const V a, const V b) { return _mm256_div_pd(a, b); }
+  static V sqrt(const V a) { return _mm256_sqrt_pd(a); }
+  static V fmadd(const V a, const V b, const V c) { return _mm256_fmadd_pd(a, b, c); }
+  static V min(const V a, const V b) { return _mm256_min_pd(a, b); }
+  static V max(const V a, const V b) { return _mm256_max_pd(a, b); }
+  static M lt(const V a, const V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static M gt(const V a, const V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  static M is_nan(const V a) { return _mm256_cmp_pd(a, a, _CMP_UNORD_Q); }
+  static M mask_and(const M a, const M b) { return _mm256_and_pd(a, b); }
+  static V select(const M m, const V a, const V b) { return _mm256_blendv_pd(b, a, m); }
+  static V bit_and(const V a, const V b) { return _mm256_and_pd(a, b); }
+  static V bit_or(const V a, const V b) { return _mm256_or_pd(a, b); }
+  static V shl_mantissa(const V a) {
+    return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a), 52));
+  }
+  static V shr_mantissa(const V a) {
+    return _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(a), 52));
+  }
+};
+
+template <> struct Vec<float> {
+  using real = float;
+  using V = __m256;
+  using M = __m256;
+  static constexpr std::size_t width = 8;
+
+  static V set1(const real a) { return _mm256_set1_ps(a); }
+  static V loadu(const real *p) { return _mm256_loadu_ps(p); }
+  static void storeu(real *p, const V a) { _mm256_storeu_ps(p, a); }
+  static V add(const V a, const V b) { return _mm256_add_ps(a, b); }
+  static V sub(const V a, const V b) { return _mm256_sub_ps(a, b); }
+  static V mul(const V a, const V b) { return _mm256_mul_ps(a, b); }
+  static V div(const V a, const V b) { return _mm256_div_ps(a, b); }
+  static V sqrt(const V a) { return _mm256_sqrt_ps(a); }
+  static V fmadd(const V a, const V b, const V c) { return _mm256_fmadd_ps(a, b, c); }
+  static V min(const V a, const V b) { return _mm256_min_ps(a, b); }
+  static V max(const V a, const V b) { return _mm256_max_ps(a, b); }
+  static M lt(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static M gt(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static M is_nan(const V a) { return _mm256_cmp_ps(a, a, _CMP_UNORD_Q); }
+  static M mask_and(const M a, const M b) { return _mm256_and_ps(a, b); }
+  static V select(const M m, const V a, const V b) { return _mm256_blendv_ps(b, a, m); }
+  static V bit_and(const V a, const V b) { return _mm256_and_ps(a, b); }
+  static V bit_or(const V a, const V b) { return _mm256_or_ps(a, b); }
+  static V shl_mantissa(const V a) {
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(a), 23));
+  }
+  static V shr_mantissa(const V a) {
+    return _mm256_castsi256_ps(_mm256_srli_epi32(_mm256_castps_si256(a), 23));
+  }
+};
+
+#include "simd_kernels.hpp"
+
+} // namespace zoo::simd::avx2
+ZOO_SIMD_POP
+
+ZOO_SIMD_PUSH_AVX512
+namespace zoo::simd::avx512 {
+
+template <class real> struct Vec;
+
+// Only AVX-512F is assumed, so bitwise operations go through the integer domain (AVX-512DQ
+// provides the floating point forms).
+template <> struct Vec<double> {
+  using real = double;
+  using V = __m512d;
+  using M = __mmask8;
+  static constexpr std::size_t width = 8;
+
+  static V set1(const real a) { return _mm512_set1_pd(a); }
+  static V loadu(const real *p) { return _mm512_loadu_pd(p); }
+  static void storeu(real *p, const V a) { _mm512_storeu_pd(p, a); }
+  static V add(const V a, const V b) { return _mm512_add_pd(a, b); }
+  static V sub(const V a, const V b) { return _mm512_sub_pd(a, b); }
+  static V mul(const V a, const V b) { return _mm512_mul_pd(a, b); }
+  static V div(const V a, const V b) { return _mm512_div_pd(a, b); }
+  static V sqrt(const V a) { return _mm512_sqrt_pd(a); }
+  static V fmadd(const V a, const V b, const V c) { return _mm512_fmadd_pd(a, b, c); }
+  static V min(const V a, const V b) { return _mm512_min_pd(a, b); }
+  static V max(const V a, const V b) { return _mm512_max_pd(a, b); }
+  static M lt(const V a, const V b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+  static M gt(const V a, const V b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+  static M is_nan(const V a) { return _mm512_cmp_pd_mask(a, a, _CMP_UNORD_Q); }
+  static M mask_and(const M a, const M b) { return static_cast<M>(a & b); }
+  static V select(const M m, const V a, const V b) { return _mm512_mask_blend_pd(m, b, a); }
+  static V bit_and(const V a, const V b) {
+    return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b)));
+  }
+  static V bit_or(const V a, const V b) {
+    return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b)));
+  }
+  static V shl_mantissa(const V a) {
+    return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(a), 52));
+  }
+  static V shr_mantissa(const V a) {
+    return _mm512_castsi512_pd(_mm512_srli_epi64(_mm512_castpd_si512(a), 52));
+  }
+};
+
+template <> struct Vec<float> {
+  using real = float;
+  using V = __m512;
+  using M = __mmask16;
+  static constexpr std::size_t width = 16;
+
+  static V set1(const real a) { return _mm512_set1_ps(a); }
+  static V loadu(const real *p) { return _mm512_loadu_ps(p); }
+  static void storeu(real *p, const V a) { _mm512_storeu_ps(p, a); }
+  static V add(const V a, const V b) { return _mm512_add_ps(a, b); }
+  static V sub(const V a, const V b) { return _mm512_sub_ps(a, b); }
+  static V mul(const V a, const V b) { return _mm512_mul_ps(a, b); }
+  static V div(const V a, const V b) { return _mm512_div_ps(a, b); }
+  static V sqrt(const V a) { return _mm512_sqrt_ps(a); }
+  static V fmadd(const V a, const V b, const V c) { return _mm512_fmadd_ps(a, b, c); }
+  static V min(const V a, const V b) { return _mm512_min_ps(a, b); }
+  static V max(const V a, const V b) { return _mm512_max_ps(a, b); }
+  static M lt(const V a, const V b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+  static M gt(const V a, const V b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+  static M is_nan(const V a) { return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q); }
+  static M mask_and(const M a, const M b) { return static_cast<M>(a & b); }
+  static V select(const M m, const V a, const V b) { return _mm512_mask_blend_ps(m, b, a); }
+  static V bit_and(const V a, const V b) {
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+  }
+  static V bit_or(const V a, const V b) {
+    return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+  }
+  static V shl_mantissa(const V a) {
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_castps_si512(a), 23));
+  }
+  static V shr_mantissa(const V a) {
+    return _mm512_castsi512_ps(_mm512_srli_epi32(_mm512_castps_si512(a), 23));
+  }
+};
+
+#include "simd_kernels.hpp"
+
+} // namespace zoo::simd::avx512
+ZOO_SIMD_POP_AVX512
+
+#endif // ZOO_SIMD_X86
+
+namespace zoo::simd {
+
+// Dispatches a kernel to the widest enabled ISA, or runs the scalar loop.
+#ifdef ZOO_SIMD_X86
+#define ZOO_SIMD_DISPATCH(kernel, ...)                                                             \
+  if constexpr (is_vectorised<real>) {                                                             \
+    switch (active_isa()) {                                                                        \
+    case Isa::Avx512:                                                                              \
+      avx512::kernel(__VA_ARGS__);                                                                 \
+      return;                                                                                      \
+    case Isa::Avx2:                                                                                \
+      avx2::kernel(__VA_ARGS__);                                                                   \
+      return;                                                                                      \
+    case Isa::Sse2:                                                                                \
+      sse2::kernel(__VA_ARGS__);                                                                   \
+      return;                                                                                      \
+    case Isa::Scalar:                                                                              \
+      break;                                                                                       \
+    }                                                                                              \
+  }
+#else
+#define ZOO_SIMD_DISPATCH(kernel, ...)
+#endif
+
+// log N(x | mean, sigma) = log_prefactor - (x - mean)^2 * inv_2_sig_sq
+template <class real>
+void normal_log_pdf(const real *x, real *out, const std::size_t n, const real mean,
+                    const real inv_2_sig_sq, const real log_prefactor) {
+  ZOO_SIMD_DISPATCH(normal_log_pdf, x, out, n, mean, inv_2_sig_sq, log_prefactor)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = log_prefactor - (x[i] - mean) * (x[i] - mean) * inv_2_sig_sq;
+  }
+}
+
+// N(x | mean, sigma) = prefactor * exp(-(x - mean)^2 * inv_2_sig_sq)
+template <class real>
+void normal_pdf(const real *x, real *out, const std::size_t n, const real mean,
+                const real inv_2_sig_sq, const real prefactor) {
+  ZOO_SIMD_DISPATCH(normal_pdf, x, out, n, mean, inv_2_sig_sq, prefactor)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = prefactor * std::exp(-(x[i] - mean) * (x[i] - mean) * inv_2_sig_sq);
+  }
+}
+
+// log Beta(x | alpha, beta) = am1 log(x) + bm1 log1p(-x) + log_beta_fn on (0, 1), else -inf
+template <class real>
+void beta_log_pdf(const real *x, real *out, const std::size_t n, const real am1, const real bm1,
+                  const real log_beta_fn) {
+  ZOO_SIMD_DISPATCH(beta_log_pdf, x, out, n, am1, bm1, log_beta_fn)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = x[i] > real{0.0} && x[i] < real{1.0}
+                 ? am1 * std::log(x[i]) + bm1 * std::log1p(-x[i]) + log_beta_fn
+                 : -std::numeric_limits<real>::infinity();
+  }
+}
+
+// Beta(x | alpha, beta), evaluated as the exponential of the log density
+template <class real>
+void beta_pdf(const real *x, real *out, const std::size_t n, const real am1, const real bm1,
+              const real log_beta_fn) {
+  ZOO_SIMD_DISPATCH(beta_pdf, x, out, n, am1, bm1, log_beta_fn)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = x[i] > real{0.0} && x[i] < real{1.0}
+                 ? std::exp(am1 * std::log(x[i]) + bm1 * std::log1p(-x[i]) + log_beta_fn)
+                 : real{0.0};
+  }
+}
+
+// Column forms for structure-of-arrays containers: entry i has its own parameters, read from the
+// i-th element of each column. x is read contiguously, or with broadcast_x set every entry is
+// evaluated at the single point x[0].
+
+template <class real>
+void normal_log_pdf_columns(const real *x, const bool broadcast_x, const real *mean,
+                            const real *inv_2_sig_sq, const real *log_prefactor, real *out,
+                            const std::size_t n) {
+  ZOO_SIMD_DISPATCH(normal_log_pdf_columns, x, broadcast_x, mean, inv_2_sig_sq, log_prefactor, out,
+                    n)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const real d = x[broadcast_x ? 0 : i] - mean[i];
+    out[i] = log_prefactor[i] - d * d * inv_2_sig_sq[i];
+  }
+}
+
+template <class real>
+void normal_pdf_columns(const real *x, const bool broadcast_x, const real *mean,
+                        const real *inv_2_sig_sq, const real *log_prefactor, real *out,
+                        const std::size_t n) {
+  ZOO_SIMD_DISPATCH(normal_pdf_columns, x, broadcast_x, mean, inv_2_sig_sq, log_prefactor, out, n)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const real d = x[broadcast_x ? 0 : i] - mean[i];
+    out[i] = std::exp(log_prefactor[i] - d * d * inv_2_sig_sq[i]);
+  }
+}
+
+template <class real>
+void beta_log_pdf_columns(const real *x, const bool broadcast_x, const real *alpha,
+                          const real *beta, const real *log_beta_fn, real *out,
+                          const std::size_t n) {
+  ZOO_SIMD_DISPATCH(beta_log_pdf_columns, x, broadcast_x, alpha, beta, log_beta_fn, out, n)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const real xi = x[broadcast_x ? 0 : i];
+    out[i] = xi > real{0.0} && xi < real{1.0}
+                 ? (alpha[i] - real{1.0}) * std::log(xi) + (beta[i] - real{1.0}) * std::log1p(-xi) +
+                       log_beta_fn[i]
+                 : -std::numeric_limits<real>::infinity();
+  }
+}
+
+template <class real>
+void beta_pdf_columns(const real *x, const bool broadcast_x, const real *alpha,
+                      const real *beta, const real *log_beta_fn, real *out, const std::size_t n) {
+  ZOO_SIMD_DISPATCH(beta_pdf_columns, x, broadcast_x, alpha, beta, log_beta_fn, out, n)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const real xi = x[broadcast_x ? 0 : i];
+    out[i] = xi > real{0.0} && xi < real{1.0}
+                 ? std::exp((alpha[i] - real{1.0}) * std::log(xi) +
+                            (beta[i] - real{1.0}) * std::log1p(-xi) + log_beta_fn[i])
+                 : real{0.0};
+  }
+}
+
+// erfc(scale (x - mean)) / 2: the normal cdf for scale = -1 / (sigma sqrt(2)), and the survival
+// function for scale = 1 / (sigma sqrt(2))
+template <class real>
+void half_erfc(const real *x, real *out, const std::size_t n, const real mean, const real scale) {
+  ZOO_SIMD_DISPATCH(half_erfc, x, out, n, mean, scale)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = real{0.5} * std::erfc(scale * (x[i] - mean));
+  }
+}
+
+// log Phi((x - mean) / sigma), with neg_scale = -1 / (sigma sqrt(2))
+template <class real>
+void normal_log_cdf(const real *x, real *out, const std::size_t n, const real mean,
+                    const real neg_scale) {
+  ZOO_SIMD_DISPATCH(normal_log_cdf, x, out, n, mean, neg_scale)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = standard_normal_log_cdf(-neg_scale * (x[i] - mean) / inv_sqrt2<real>);
+  }
+}
+
+// mean + sigma Phi^-1(p)
+template <class real>
+void normal_quantile(const real *p, real *out, const std::size_t n, const real mean,
+                     const real std_dev) {
+  ZOO_SIMD_DISPATCH(normal_quantile, p, out, n, mean, std_dev)
+
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = mean + std_dev * standard_normal_quantile(p[i]);
+  }
+}
+
+} // namespace zoo::simd
+
+#endif // ZOO_SIMD_HPP_
@@ -0,0 +1,549 @@
+/*
+MIT License
+
+Copyright (c) 2019 University of Oxford
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ISA-generic kernel bodies. This file deliberately has no include guard: simd.hpp includes it once
+// per instruction set, inside a namespace that defines Vec<float> and Vec<double> and under the
+// matching target pragma, so each copy is compiled for that ISA.
+
+// Cephes-style exp. Results below the normal range are flushed to zero.
+template <class real> typename Vec<real>::V exp(const typename Vec<real>::V x) {
+  using Ops = Vec<real>;
+  using V = typename Ops::V;
+
+  constexpr bool is_float = std::is_same_v<real, float>;
+  constexpr real max_log = is_float ? real(88.72283f) : real(709.782712893383996843);
+  constexpr real min_log = is_float ? real(-86.9f) : real(-708.0);
+  constexpr real log2e = real(1.44269504088896340736);
+  constexpr real ln2_hi = is_float ? real(0.693359375) : real(6.93145751953125E-1);
+  constexpr real ln2_lo = is_float ? real(-2.12194440e-4) : real(1.42860682030941723212E-6);
+  constexpr real round_magic = is_float ? real(12582912.0) : real(6755399441055744.0);
+  constexpr real exponent_magic = is_float ? real(8388608.0 + 127.0 - 1.0)
+                                           : real(4503599627370496.0 + 1023.0 - 1.0);
+
+  const V xc = Ops::min(Ops::max(x, Ops::set1(min_log)), Ops::set1(max_log));
+
+  // x = n ln2 + r with |r| <= ln2 / 2
+  const V n = Ops::sub(Ops::fmadd(xc, Ops::set1(log2e), Ops::set1(round_magic)),
+                       Ops::set1(round_magic));
+  V r = Ops::fmadd(n, Ops::set1(-ln2_hi), xc);
+  r = Ops::fmadd(n, Ops::set1(-ln2_lo), r);
+
+  V y;
+  if constexpr (is_float) {
+    y = Ops::set1(1.9875691500E-4f);
+    y = Ops::fmadd(y, r, Ops::set1(1.3981999507E-3f));
+    y = Ops::fmadd(y, r, Ops::set1(8.3334519073E-3f));
+    y = Ops::fmadd(y, r, Ops::set1(4.1665795894E-2f));
+    y = Ops::fmadd(y, r, Ops::set1(1.6666665459E-1f));
+    y = Ops::fmadd(y, r, Ops::set1(5.0000001201E-1f));
+    y = Ops::add(Ops::fmadd(y, Ops::mul(r, r), r), Ops::set1(1.0f));
+  } else {
+    const V rr = Ops::mul(r, r);
+    V p = Ops::set1(1.26177193074810590878E-4);
+    p = Ops::fmadd(p, rr, Ops::set1(3.02994407707441961300E-2));
+    p = Ops::fmadd(p, rr, Ops::set1(9.99999999999999999910E-1));
+    p = Ops::mul(p, r);
+    V q = Ops::set1(3.00198505138664455042E-6);
+    q = Ops::fmadd(q, rr, Ops::set1(2.52448340349684104192E-3));
+    q = Ops::fmadd(q, rr, Ops::set1(2.27265548208155028766E-1));
+    q = Ops::fmadd(q, rr, Ops::set1(2.00000000000000000009E0));
+    y = Ops::fmadd(Ops::set1(2.0), Ops::div(p, Ops::sub(q, p)), Ops::set1(1.0));
+  }
+
+  // Scale by 2^(n-1) then 2, so that n can reach the top of the exponent range
+  const V scale = Ops::shl_mantissa(Ops::add(n, Ops::set1(exponent_magic)));
+  y = Ops::mul(Ops::mul(y, scale), Ops::set1(real(2.0)));
+
+  y = Ops::select(Ops::gt(x, Ops::set1(max_log)),
+                  Ops::set1(std::numeric_limits<real>::infinity()), y);
+  y = Ops::select(Ops::lt(x, Ops::set1(min_log)), Ops::set1(real(0.0)), y);
+  return Ops::select(Ops::is_nan(x), x, y);
+}
+
+// Cephes-style log for finite x > 0, including subnormals. Callers mask any other lanes.
+template <class real> typename Vec<real>::V log(typename Vec<real>::V x) {
+  using Ops = Vec<real>;
+  using V = typename Ops::V;
+
+  constexpr bool is_float = std::is_same_v<real, float>;
+  constexpr real subnormal_scale = is_float ? real(33554432.0) : real(18014398509481984.0);
+  constexpr real subnormal_exponent = is_float ? real(-25.0) : real(-54.0);
+  constexpr real mantissa_mask =
+      std::numeric_limits<real>::min() - std::numeric_limits<real>::denorm_min();
+  constexpr real exponent_magic = is_float ? real(8388608.0) : real(4503599627370496.0);
+  constexpr real exponent_bias = is_float ? real(126.0) : real(1022.0);
+  constexpr real sqrt_half = real(0.70710678118654752440);
+  constexpr real ln2_hi = real(0.693359375);
+  constexpr real ln2_lo = is_float ? real(-2.12194440e-4) : real(-2.121944400546905827679e-4);
+
+  // Rescale subnormals into the normal range so the exponent field is meaningful
+  const auto subnormal = Ops::lt(x, Ops::set1(std::numeric_limits<real>::min()));
+  x = Ops::select(subnormal, Ops::mul(x, Ops::set1(subnormal_scale)), x);
+
+  // x = m 2^e with m in [0.5, 1)
+  V e = Ops::sub(Ops::bit_or(Ops::shr_mantissa(x), Ops::set1(exponent_magic)),
+                 Ops::set1(exponent_magic + exponent_bias));
+  e = Ops::add(e, Ops::select(subnormal, Ops::set1(subnormal_exponent), Ops::set1(real(0.0))));
+  V m = Ops::bit_or(Ops::bit_and(x, Ops::set1(mantissa_mask)), Ops::set1(real(0.5)));
+
+  // Shift m into [sqrt(1/2), sqrt(2)) and take log(1 + m)
+  const auto small = Ops::lt(m, Ops::set1(sqrt_half));
+  e = Ops::sub(e, Ops::select(small, Ops::set1(real(1.0)), Ops::set1(real(0.0))));
+  m = Ops::sub(Ops::add(m, Ops::select(small, m, Ops::set1(real(0.0)))), Ops::set1(real(1.0)));
+
+  const V z = Ops::mul(m, m);
+  V y;
+  if constexpr (is_float) {
+    y = Ops::set1(7.0376836292E-2f);
+    y = Ops::fmadd(y, m, Ops::set1(-1.1514610310E-1f));
+    y = Ops::fmadd(y, m, Ops::set1(1.1676998740E-1f));
+    y = Ops::fmadd(y, m, Ops::set1(-1.2420140846E-1f));
+    y = Ops::fmadd(y, m, Ops::set1(1.4249322787E-1f));
+    y = Ops::fmadd(y, m, Ops::set1(-1.6668057665E-1f));
+    y = Ops::fmadd(y, m, Ops::set1(2.0000714765E-1f));
+    y = Ops::fmadd(y, m, Ops::set1(-2.4999993993E-1f));
+    y = Ops::fmadd(y, m, Ops::set1(3.3333331174E-1f));
+    y = Ops::mul(Ops::mul(y, m), z);
+  } else {
+    V p = Ops::set1(1.01875663804580931796E-4);
+    p = Ops::fmadd(p, m, Ops::set1(4.97494994976747001425E-1));
+    p = Ops::fmadd(p, m, Ops::set1(4.70579119878881725854E0));
+    p = Ops::fmadd(p, m, Ops::set1(1.44989225341610930846E1));
+    p = Ops::fmadd(p, m, Ops::set1(1.79368678507819816313E1));
+    p = Ops::fmadd(p, m, Ops::set1(7.70838733755885391666E0));
+    V q = Ops::add(m, Ops::set1(1.12873587189167450590E1));
+    q = Ops::fmadd(q, m, Ops::set1(4.52279145837532221105E1));
+    q = Ops::fmadd(q, m, Ops::set1(8.29875266912776603211E1));
+    q = Ops::fmadd(q, m, Ops::set1(7.11544750618563894466E1));
+    q = Ops::fmadd(q, m, Ops::set1(2.31251620126765340583E1));
+    y = Ops::mul(m, Ops::div(Ops::mul(z, p), q));
+  }
+
+  y = Ops::fmadd(e, Ops::set1(ln2_lo), y);
+  y = Ops::fmadd(z, Ops::set1(real(-0.5)), y);
+  return Ops::fmadd(e, Ops::set1(ln2_hi), Ops::add(m, y));
+}
+
+// log(1 + t) for t > -1, correcting log(u) for the rounding error in u = 1 + t.
+template <class real> typename Vec<real>::V log1p(const typename Vec<real>::V t) {
+  using Ops = Vec<real>;
+  const auto u = Ops::add(Ops::set1(real(1.0)), t);
+  const auto correction = Ops::div(Ops::sub(t, Ops::sub(u, Ops::set1(real(1.0)))), u);
+  return Ops::add(log<real>(u), correction);
+}
+
+// Applies fn to every element of x, padding the final partial vector through a stack buffer.
+template <class real, class Fn>
+void transform(const real *x, real *out, const std::size_t n, const Fn &fn) {
+  using Ops = Vec<real>;
+  constexpr std::size_t w = Ops::width;
+
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    Ops::storeu(out + i, fn(Ops::loadu(x + i)));
+  }
+
+  if (i < n) {
+    real buf[w] = {};
+    std::copy(x + i, x + n, buf);
+    Ops::storeu(buf, fn(Ops::loadu(buf)));
+    std::copy(buf, buf + (n - i), out + i);
+  }
+}
+
+template <class real> struct NormalLogPdf {
+  using Ops = Vec<real>;
+  typename Ops::V mean;
+  typename Ops::V inv_2_sig_sq;
+  typename Ops::V log_prefactor;
+
+  typename Ops::V operator()(const typename Ops::V x) const {
+    const auto d = Ops::sub(x, mean);
+    return Ops::sub(log_prefactor, Ops::mul(Ops::mul(d, d), inv_2_sig_sq));
+  }
+};
+
+template <class real> struct NormalPdf {
+  using Ops = Vec<real>;
+  typename Ops::V mean;
+  typename Ops::V neg_inv_2_sig_sq;
+  typename Ops::V prefactor;
+
+  typename Ops::V operator()(const typename Ops::V x) const {
+    const auto d = Ops::sub(x, mean);
+    return Ops::mul(prefactor, exp<real>(Ops::mul(Ops::mul(d, d), neg_inv_2_sig_sq)));
+  }
+};
+
+template <class real>
+void normal_log_pdf(const real *x, real *out, const std::size_t n, const real mean,
+                    const real inv_2_sig_sq, const real log_prefactor) {
+  using Ops = Vec<real>;
+  transform(x, out, n,
+            NormalLogPdf<real>{Ops::set1(mean), Ops::set1(inv_2_sig_sq), Ops::set1(log_prefactor)});
+}
+
+template <class real>
+void normal_pdf(const real *x, real *out, const std::size_t n, const real mean,
+                const real inv_2_sig_sq, const real prefactor) {
+  using Ops = Vec<real>;
+  transform(x, out, n,
+            NormalPdf<real>{Ops::set1(mean), Ops::set1(-inv_2_sig_sq), Ops::set1(prefactor)});
+}
+
+// Lanes outside (0, 1), including NaN, are masked to the log density of -inf without branching.
+template <class real> struct BetaLogPdf {
+  using Ops = Vec<real>;
+  typename Ops::V am1;
+  typename Ops::V bm1;
+  typename Ops::V log_beta_fn;
+
+  typename Ops::V operator()(const typename Ops::V x) const {
+    const auto in_support = Ops::mask_and(Ops::gt(x, Ops::set1(real(0.0))),
+                                          Ops::lt(x, Ops::set1(real(1.0))));
+    const auto xs = Ops::select(in_support, x, Ops::set1(real(0.5)));
+
+    auto lp = Ops::fmadd(am1, log<real>(xs), log_beta_fn);
+    lp = Ops::fmadd(bm1, log1p<real>(Ops::sub(Ops::set1(real(0.0)), xs)), lp);
+    return Ops::select(in_support, lp, Ops::set1(-std::numeric_limits<real>::infinity()));
+  }
+};
+
+template <class real> struct BetaPdf {
+  BetaLogPdf<real> log_pdf;
+
+  typename Vec<real>::V operator()(const typename Vec<real>::V x) const {
+    return exp<real>(log_pdf(x));
+  }
+};
+
+template <class real>
+void beta_log_pdf(const real *x, real *out, const std::size_t n, const real am1, const real bm1,
+                  const real log_beta_fn) {
+  using Ops = Vec<real>;
+  transform(x, out, n, BetaLogPdf<real>{Ops::set1(am1), Ops::set1(bm1), Ops::set1(log_beta_fn)});
+}
+
+template <class real>
+void beta_pdf(const real *x, real *out, const std::size_t n, const real am1, const real bm1,
+              const real log_beta_fn) {
+  using Ops = Vec<real>;
+  transform(x, out, n,
+            BetaPdf<real>{{Ops::set1(am1), Ops::set1(bm1), Ops::set1(log_beta_fn)}});
+}
+
+// Like transform, for an fn taking one vector from each of k input columns. A column is either read
+// contiguously or, where broadcast is set, has its first element fill every lane.
+template <std::size_t k, class real, class Fn>
+void transform_columns(const real *const *cols, const bool *broadcast, real *out,
+                       const std::size_t n, const Fn &fn) {
+  using Ops = Vec<real>;
+  constexpr std::size_t w = Ops::width;
+  typename Ops::V v[k];
+  for (std::size_t c = 0; c < k; ++c) {
+    if (broadcast[c]) {
+      v[c] = Ops::set1(cols[c][0]);
+    }
+  }
+  std::size_t i = 0;
+  for (; i + w <= n; i += w) {
+    for (std::size_t c = 0; c < k; ++c) {
+      if (!broadcast[c]) {
+        v[c] = Ops::loadu(cols[c] + i);
+      }
+    }
+    Ops::storeu(out + i, fn(v));
+  }
+  if (i < n) {
+    real buf[k][w] = {};
+    for (std::size_t c = 0; c < k; ++c) {
+      if (!broadcast[c]) {
+        std::copy(cols[c] + i, cols[c] + n, buf[c]);
+        v[c] = Ops::loadu(buf[c]);
+      }
+    }
+    Ops::storeu(buf[0], fn(v));
+    std::copy(buf[0], buf[0] + (n - i), out + i);
+  }
+}
+
+// Columns: x, mean, inv_2_sig_sq, log_prefactor
+template <class real> struct NormalLogPdfColumns {
+  typename Vec<real>::V operator()(const typename Vec<real>::V *v) const {
+    return NormalLogPdf<real>{v[1], v[2], v[3]}(v[0]);
+  }
+};
+
+template <class real> struct NormalPdfColumns {
+  typename Vec<real>::V operator()(const typename Vec<real>::V *v) const {
+    return exp<real>(NormalLogPdfColumns<real>{}(v));
+  }
+};
+
+// Columns: x, alpha, beta, log_beta_fn
+template <class real> struct BetaLogPdfColumns {
+  typename Vec<real>::V operator()(const typename Vec<real>::V *v) const {
+    using Ops = Vec<real>;
+    const auto one = Ops::set1(real(1.0));
+    return BetaLogPdf<real>{Ops::sub(v[1], one), Ops::sub(v[2], one), v[3]}(v[0]);
+  }
+};
+
+template <class real> struct BetaPdfColumns {
+  typename Vec<real>::V operator()(const typename Vec<real>::V *v) const {
+    return exp<real>(BetaLogPdfColumns<real>{}(v));
+  }
+};
+
+template <class real>
+void normal_log_pdf_columns(const real *x, const bool broadcast_x, const real *mean,
+                            const real *inv_2_sig_sq, const real *log_prefactor, real *out,
+                            const std::size_t n) {
+  const real *const cols[] = {x, mean, inv_2_sig_sq, log_prefactor};
+  const bool broadcast[] = {broadcast_x, false, false, false};
+  transform_columns<4>(cols, broadcast, out, n, NormalLogPdfColumns<real>{});
+}
+
+template <class real>
+void normal_pdf_columns(const real *x, const bool broadcast_x, const real *mean,
+                        const real *inv_2_sig_sq, const real *log_prefactor, real *out,
+                        const std::size_t n) {
+  const real *const cols[] = {x, mean, inv_2_sig_sq, log_prefactor};
+  const bool broadcast[] = {broadcast_x, false, false, false};
+  transform_columns<4>(cols, broadcast, out, n, NormalPdfColumns<real>{});
+}
+
+template <class real>
+void beta_log_pdf_columns(const real *x, const bool broadcast_x, const real *alpha,
+                          const real *beta, const real *log_beta_fn, real *out,
+                          const std::size_t n) {
+  const real *const cols[] = {x, alpha, beta, log_beta_fn};
+  const bool broadcast[] = {broadcast_x, false, false, false};
+  transform_columns<4>(cols, broadcast, out, n, BetaLogPdfColumns<real>{});
+}
+
+template <class real>
+void beta_pdf_columns(const real *x, const bool broadcast_x, const real *alpha,
+                      const real *beta, const real *log_beta_fn, real *out, const std::size_t n) {
+  const real *const cols[] = {x, alpha, beta, log_beta_fn};
+  const bool broadcast[] = {broadcast_x, false, false, false};
+  transform_columns<4>(cols, broadcast, out, n, BetaPdfColumns<real>{});
+}
+
+// c[0] + c[1] x + ... + c[n - 1] x^(n - 1), by Horner's rule
+template <class real, std::size_t n>
+typename Vec<real>::V polynomial(const typename Vec<real>::V x, const long double (&c)[n]) {
+  using Ops = Vec<real>;
+  auto y = Ops::set1(static_cast<real>(c[n - 1]));
+  for (std::size_t i = n - 1; i-- > 0;) {
+    y = Ops::fmadd(y, x, Ops::set1(static_cast<real>(c[i])));
+  }
+  return y;
+}
+
+// Coefficients of Cephes' erf and erfc rational approximations, lowest order first
+struct CephesErfc {
+  // erf(x) = x T(x^2) / U(x^2) for |x| < 1
+  static constexpr long double t[5] = {5.55923013010394962768E4L, 7.00332514112805075473E3L,
+                                       2.23200534594684319226E3L, 9.00260197203842689217E1L,
+                                       9.60497373987051638749E0L};
+  static constexpr long double u[6] = {4.92673942608635921086E4L, 2.26290000613890934246E4L,
+                                       4.59432382970980127987E3L, 5.21357949780152679795E2L,
+                                       3.35617141647503099647E1L, 1.0L};
+  // erfc(x) = exp(-x^2) P(x) / Q(x) for 1 <= x < 8
+  static constexpr long double p[9] = {
+      5.57535335369399327526E2L, 1.02755188689515710272E3L, 9.34528527171957607540E2L,
+      5.26445194995477358631E2L, 1.96520832956077098242E2L, 4.86371970985681366614E1L,
+      7.46321056442269912687E0L, 5.64189564831068821977E-1L, 2.46196981473530512524E-10L};
+  static constexpr long double q[9] = {
+      5.57535340817727675546E2L, 1.65666309194161350182E3L, 2.24633760818710981792E3L,
+      1.82390916687909736289E3L, 9.75708501743205489753E2L, 3.54937778887819891062E2L,
+      8.67072140885989742329E1L, 1.32281951154744992508E1L, 1.0L};
+  // erfc(x) = exp(-x^2) R(x) / S(x) for x >= 8
+  static constexpr long double r[6] = {2.97886665372100240670E0L, 7.40974269950448939160E0L,
+                                       6.16021097993053585195E0L, 5.01905042251180477414E0L,
+                                       1.27536670759978104416E0L, 5.64189583547755073984E-1L};
+  static constexpr long double s[7] = {3.36907645100081516050E0L, 9.60896809063285878198E0L,
+                                       1.70814450747565897222E1L, 1.20489539808096656605E1L,
+                                       9.39603524938001434673E0L, 2.26052863220117276590E0L,
+                                       1.0L};
+};
+
+// Cephes-style erfc, evaluating every branch and selecting per lane. Results below the normal
+// range are flushed to zero, as in exp.
+template <class real> typename Vec<real>::V erfc(const typename Vec<real>::V a) {
+  using Ops = Vec<real>;
+  using V = typename Ops::V;
+  constexpr bool is_float = std::is_same_v<real, float>;
+
+  // Beyond this erfc has underflowed; clamping keeps the rational functions finite
+  constexpr real cap = is_float ? real(10.0) : real(27.0);
+  constexpr real round_magic = is_float ? real(12582912.0) : real(6755399441055744.0);
+
+  const V zero = Ops::set1(real(0.0));
+  const V one = Ops::set1(real(1.0));
+  const V x = Ops::min(Ops::max(a, Ops::sub(zero, a)), Ops::set1(cap));
+
+  // 1 - erf(x) for x < 1
+  const V z = Ops::mul(x, x);
+  const V near = Ops::sub(one, Ops::div(Ops::mul(x, polynomial<real>(z, CephesErfc::t)),
+                                        polynomial<real>(z, CephesErfc::u)));
+
+  // exp(-x^2) with x = m + f, where m is a multiple of 1/128 so that m^2 is exact
+  const V m = Ops::mul(Ops::sub(Ops::fmadd(x, Ops::set1(real(128.0)), Ops::set1(round_magic)),
+                                Ops::set1(round_magic)),
+                       Ops::set1(real(0.0078125)));
+  const V f = Ops::sub(x, m);
+  const V m2f = Ops::fmadd(Ops::mul(Ops::set1(real(2.0)), m), f, Ops::mul(f, f));
+  const V e = Ops::mul(exp<real>(Ops::sub(zero, Ops::mul(m, m))), exp<real>(Ops::sub(zero, m2f)));
+
+  const V mid = Ops::div(polynomial<real>(x, CephesErfc::p), polynomial<real>(x, CephesErfc::q));
+  const V far = Ops::div(polynomial<real>(x, CephesErfc::r), polynomial<real>(x, CephesErfc::s));
+  const V tail = Ops::mul(e, Ops::select(Ops::lt(x, Ops::set1(real(8.0))), mid, far));
+
+  V y = Ops::select(Ops::lt(x, one), near, tail);
+  y = Ops::select(Ops::lt(a, zero), Ops::sub(Ops::set1(real(2.0)), y), y);
+  return Ops::select(Ops::is_nan(a), a, y);
+}
+
+// erfc(scale (x - mean)) / 2, the normal cdf for scale = -1 / (sigma sqrt(2)) and the survival
+// function for scale = 1 / (sigma sqrt(2))
+template <class real> struct HalfErfc {
+  using Ops = Vec<real>;
+  typename Ops::V mean;
+  typename Ops::V scale;
+
+  typename Ops::V operator()(const typename Ops::V x) const {
+    return Ops::mul(Ops::set1(real(0.5)), erfc<real>(Ops::mul(scale, Ops::sub(x, mean))));
+  }
+};
+
+// log Phi((x - mean) / sigma), with neg_scale = -1 / (sigma sqrt(2)). Above the mean this is
+// log1p of minus the small upper tail; far below it, where Phi underflows, it is the asymptotic
+// series of standard_normal_log_cdf_tail.
+template <class real> struct NormalLogCdf {
+  using Ops = Vec<real>;
+  typename Ops::V mean;
+  typename Ops::V neg_scale;
+
+  typename Ops::V operator()(const typename Ops::V x) const {
+    using V = typename Ops::V;
+    const V zero = Ops::set1(real(0.0));
+    const V one = Ops::set1(real(1.0));
+    const V t = Ops::mul(neg_scale, Ops::sub(x, mean));
+    const V abs_t = Ops::max(t, Ops::sub(zero, t));
+
+    // The smaller of the two tails, Phi(z) below the mean and 1 - Phi(z) above it
+    const V tail = Ops::mul(Ops::set1(real(0.5)), erfc<real>(abs_t));
+    const auto upper = Ops::lt(t, zero);
+    const auto underflow = Ops::lt(tail, Ops::set1(std::numeric_limits<real>::min()));
+
+    const V log_tail = log<real>(Ops::select(underflow, one, tail));
+    const V log1p_tail = log1p<real>(Ops::sub(zero, tail));
+
+    // z = -t sqrt(2) in the asymptotic series, so 1 / z^2 = 1 / (2 t^2)
+    const V safe_t = Ops::select(underflow, Ops::min(abs_t, Ops::set1(real(1e15))), one);
+    const V w = Ops::div(Ops::set1(real(0.5)), Ops::mul(safe_t, safe_t));
+    V series = one;
+    V term = one;
+    for (int k = 1; k < 8; ++k) {
+      term = Ops::mul(term, Ops::mul(Ops::set1(-static_cast<real>(2 * k - 1)), w));
+      series = Ops::add(series, term);
+    }
+    // -z^2 / 2 - log(-z) - log(2 pi) / 2 = -t^2 - log(t) - log(2 sqrt(pi))
+    V asymptotic = Ops::sub(Ops::sub(zero, Ops::mul(abs_t, abs_t)), log<real>(safe_t));
+    asymptotic = Ops::add(Ops::sub(asymptotic, Ops::set1(real(1.2655121234846453964889L))),
+                          log<real>(series));
+
+    V y = Ops::select(underflow, asymptotic, log_tail);
+    y = Ops::select(upper, log1p_tail, y);
+    return Ops::select(Ops::is_nan(x), x, y);
+  }
+};
+
+// mean + sigma Phi^-1(p) by AS 241, evaluating every branch and selecting per lane
+template <class real> struct NormalQuantile {
+  using Ops = Vec<real>;
+  typename Ops::V mean;
+  typename Ops::V std_dev;
+
+  typename Ops::V operator()(const typename Ops::V p) const {
+    using V = typename Ops::V;
+    const V zero = Ops::set1(real(0.0));
+    const V one = Ops::set1(real(1.0));
+    const V half = Ops::set1(real(0.5));
+
+    const V q = Ops::sub(p, half);
+    const V r_central = Ops::sub(Ops::set1(real(0.180625)), Ops::mul(q, q));
+    const V central = Ops::div(Ops::mul(q, polynomial<real>(r_central, As241::central_num)),
+                               polynomial<real>(r_central, As241::central_den));
+
+    // Lanes at or beyond 0 and 1 take a harmless value here and are fixed up below
+    const auto lower = Ops::lt(q, zero);
+    const V tail_p = Ops::select(lower, p, Ops::sub(one, p));
+    const auto in_range = Ops::gt(tail_p, zero);
+    const V r = Ops::sqrt(Ops::sub(zero, log<real>(Ops::select(in_range, tail_p, half))));
+    const V r_near = Ops::sub(r, Ops::set1(real(1.6)));
+    const V r_far = Ops::sub(r, Ops::set1(real(5.0)));
+    const V near = Ops::div(polynomial<real>(r_near, As241::near_num),
+                            polynomial<real>(r_near, As241::near_den));
+    const V far = Ops::div(polynomial<real>(r_far, As241::far_num),
+                           polynomial<real>(r_far, As241::far_den));
+    V tail = Ops::select(Ops::gt(r, Ops::set1(real(5.0))), far, near);
+    tail = Ops::select(lower, Ops::sub(zero, tail), tail);
+
+    const auto is_central = Ops::mask_and(Ops::gt(q, Ops::set1(real(-0.425))),
+                                          Ops::lt(q, Ops::set1(real(0.425))));
+    V y = Ops::select(is_central, central, tail);
+
+    // p = 0 and p = 1 map to the infinities, and anything outside [0, 1] to NaN
+    const V inf = Ops::set1(std::numeric_limits<real>::infinity());
+    const V nan = Ops::set1(std::numeric_limits<real>::quiet_NaN());
+    y = Ops::select(in_range, y, Ops::select(lower, Ops::sub(zero, inf), inf));
+    y = Ops::select(Ops::lt(p, zero), nan, y);
+    y = Ops::select(Ops::gt(p, one), nan, y);
+    y = Ops::fmadd(std_dev, y, mean);
+    return Ops::select(Ops::is_nan(p), p, y);
+  }
+};
+
+template <class real>
+void half_erfc(const real *x, real *out, const std::size_t n, const real mean, const real scale) {
+  using Ops = Vec<real>;
+  transform(x, out, n, HalfErfc<real>{Ops::set1(mean), Ops::set1(scale)});
+}
+
+template <class real>
+void normal_log_cdf(const real *x, real *out, const std::size_t n, const real mean,
+                    const real neg_scale) {
+  using Ops = Vec<real>;
+  transform(x, out, n, NormalLogCdf<real>{Ops::set1(mean), Ops::set1(neg_scale)});
+}
+
+template <class real>
+void normal_quantile(const real *p, real *out, const std::size_t n, const real mean,
+                     const real std_dev) {
+  using Ops = Vec<real>;
+  transform(p, out, n, NormalQuantile<real>{Ops::set1(mean), Ops::set1(std_dev)});
+}
@@ -0,0 +1,410 @@
+/*
+MIT License
+
+Copyright (c) 2019 University of Oxford
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ZOO_SPECIAL_FUNCTIONS_HPP_
+#define ZOO_SPECIAL_FUNCTIONS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Scalar special functions behind the cdf and quantile methods. The vectorised kernels in simd.hpp
+// fall back to these for long double and on other architectures.
+namespace zoo {
+
+template <class real> constexpr real inv_sqrt2 = real{0.70710678118654752440084436210485L};
+template <class real> constexpr real log_sqrt_2pi = real{0.91893853320467274178032973640562L};
+
+// Asymptotic expansion of log Phi(z) for z far in the lower tail, where Phi(z) is not
+// representable: log Phi(z) = -z^2 / 2 - log(-z) - log(2 pi) / 2 + log(1 - 1/z^2 + 3/z^4 - ...).
+// Eight terms are ample wherever Phi(z) underflows, even for float.
+template <class real> real standard_normal_log_cdf_tail(const real z) {
+  const real w = real{1.0} / (z * z);
+  real series{0.0};
+  real term{1.0};
+  for (int k = 1; k <= 8; ++k) {
+    series += term;
+    term *= -static_cast<real>(2 * k - 1) * w;
+  }
+  return real{-0.5} * z * z - std::log(-z) - log_sqrt_2pi<real> + std::log(series);
+}
+
+// log Phi(z) for the standard normal, accurate in both tails
+template <class real> real standard_normal_log_cdf(const real z) {
+  if (z > real{0.0}) {
+    return std::log1p(real{-0.5} * std::erfc(z * inv_sqrt2<real>));
+  }
+  const real cdf = real{0.5} * std::erfc(-z * inv_sqrt2<real>);
+  return cdf >= std::numeric_limits<real>::min() ? std::log(cdf)
+                                                 : standard_normal_log_cdf_tail(z);
+}
+
+// Coefficients of the rational approximations in Wichura (1988), "Algorithm AS 241: The percentage
+// points of the normal distribution" (PPND16), lowest order first. The central one applies for
+// |p - 1/2| <= 0.425 in r = 0.180625 - (p - 1/2)^2, and the tail ones in r = sqrt(-log(min(p, 1 -
+// p))) - 1.6 while that is at most 3.4, and r - 5 beyond.
+struct As241 {
+  static constexpr long double central_num[8] = {
+      3.387132872796366608L,   133.14166789178437745L,  1971.5909503065514427L,
+      13731.693765509461125L,  45921.953931549871457L,  67265.770927008700853L,
+      33430.575583588128105L,  2509.0809287301226727L};
+  static constexpr long double central_den[8] = {
+      1.0L,                    42.313330701600911252L,  687.1870074920579083L,
+      5394.1960214247511077L,  21213.794301586595867L,  39307.89580009271061L,
+      28729.085735721942674L,  5226.495278852545925L};
+  static constexpr long double near_num[8] = {
+      1.42343711074968357734L, 4.6303378461565452959L,  5.7694972214606914055L,
+      3.64784832476320460504L, 1.27045825245236838258L, 0.24178072517745061177L,
+      0.0227238449892691845833L, 7.7454501427834140764e-4L};
+  static constexpr long double near_den[8] = {
+      1.0L,                    2.05319162663775882187L, 1.6763848301838038494L,
+      0.68976733498510000455L, 0.14810397642748007459L, 0.0151986665636164571966L,
+      5.475938084995344946e-4L, 1.05075007164441684324e-9L};
+  static constexpr long double far_num[8] = {
+      6.6579046435011037772L,  5.4637849111641143699L,  1.7848265399172913358L,
+      0.29656057182850489123L, 0.026532189526576123093L, 0.0012426609473880784386L,
+      2.71155556874348757815e-5L, 2.01033439929228813265e-7L};
+  static constexpr long double far_den[8] = {
+      1.0L,                    0.59983220655588793769L, 0.13692988092273580531L,
+      0.0148753612908506148525L, 7.868691311456132591e-4L, 1.8463183175100546818e-5L,
+      1.4215117583164458887e-7L, 2.04426310338993978564e-15L};
+};
+
+// c[0] + c[1] x + ... + c[n - 1] x^(n - 1), by Horner's rule
+template <class real, std::size_t n>
+real polynomial(const real x, const long double (&c)[n]) {
+  real y = static_cast<real>(c[n - 1]);
+  for (std::size_t i = n - 1; i-- > 0;) {
+    y = y * x + static_cast<real>(c[i]);
+  }
+  return y;
+}
+
+// Inverse of Phi for the standard normal by AS 241, accurate to about 1e-16. Long double takes one
+// further Newton step to reach its own precision.
+template <class real> real standard_normal_quantile(const real p) {
+  if (!(p > real{0.0} && p < real{1.0})) {
+    if (p == real{0.0}) {
+      return -std::numeric_limits<real>::infinity();
+    }
+    if (p == real{1.0}) {
+      return std::numeric_limits<real>::infinity();
+    }
+    return std::numeric_limits<real>::quiet_NaN();
+  }
+
+  const real q = p - real{0.5};
+  real val;
+  if (std::fabs(q) <= real{0.425}) {
+    const real r = real{0.180625} - q * q;
+    val = q * polynomial(r, As241::central_num) / polynomial(r, As241::central_den);
+  } else {
+    const real r = std::sqrt(-std::log(q < real{0.0} ? p : real{1.0} - p));
+    if (r <= real{5.0}) {
+      val = polynomial(r - real{1.6}, As241::near_num) / polynomial(r - real{1.6}, As241::near_den);
+    } else {
+      val = polynomial(r - real{5.0}, As241::far_num) / polynomial(r - real{5.0}, As241::far_den);
+    }
+    val = q < real{0.0} ? -val : val;
+  }
+
+  if constexpr (std::numeric_limits<real>::digits > 53) {
+    // Newton step on whichever tail is small, so that the residual keeps its precision
+    const real density = std::exp(real{-0.5} * val * val - log_sqrt_2pi<real>);
+    if (q < real{0.0}) {
+      val -= (real{0.5} * std::erfc(-val * inv_sqrt2<real>) - p) / density;
+    } else {
+      val += (real{0.5} * std::erfc(val * inv_sqrt2<real>) - (real{1.0} - p)) / density;
+    }
+  }
+  return val;
+}
+
+// Partial numerators of the continued fraction for I_x(a, b), divided through by x: step m
+// contributes x * even(m) and then x * odd(m), and odd(0) opens the fraction.
+template <class real> struct IncompleteBetaTerms {
+  real a;
+  real b;
+
+  real even(const int m) const {
+    const auto rm = static_cast<real>(m);
+    return rm * (b - rm) / ((a - real{1.0} + real{2.0} * rm) * (a + real{2.0} * rm));
+  }
+
+  real odd(const int m) const {
+    const auto rm = static_cast<real>(m);
+    return -(a + rm) * (a + b + rm) / ((a + real{2.0} * rm) * (a + real{1.0} + real{2.0} * rm));
+  }
+};
+
+// Continued fraction for I_x(a, b), evaluated by the modified Lentz method, as in Numerical
+// Recipes' betacf. It converges quickly for x < (a + 1) / (a + b + 2).
+template <class real, class Terms>
+real incomplete_beta_continued_fraction(const Terms &terms, const real x) {
+  constexpr real eps = std::numeric_limits<real>::epsilon();
+  constexpr real tiny = std::numeric_limits<real>::min() / eps;
+  constexpr int max_iterations = 10000;
+
+  real c{1.0};
+  real d = real{1.0} + x * terms.odd(0);
+  d = std::fabs(d) < tiny ? tiny : d;
+  d = real{1.0} / d;
+  real h = d;
+
+  for (int m = 1; m <= max_iterations; ++m) {
+    // Even step
+    real aa = x * terms.even(m);
+    d = real{1.0} + aa * d;
+    d = std::fabs(d) < tiny ? tiny : d;
+    c = real{1.0} + aa / c;
+    c = std::fabs(c) < tiny ? tiny : c;
+    d = real{1.0} / d;
+    h *= d * c;
+
+    // Odd step
+    aa = x * terms.odd(m);
+    d = real{1.0} + aa * d;
+    d = std::fabs(d) < tiny ? tiny : d;
+    c = real{1.0} + aa / c;
+    c = std::fabs(c) < tiny ? tiny : c;
+    d = real{1.0} / d;
+    const real delta = d * c;
+    h *= delta;
+
+    if (std::fabs(delta - real{1.0}) <= eps) {
+      break;
+    }
+  }
+  return h;
+}
+
+// Regularised incomplete beta function I_x(a, b), the cdf of Beta(a, b) at x, or its complement
+// 1 - I_x(a, b) when upper is set. log_inv_beta_fn is -log B(a, b), which callers with fixed
+// parameters cache rather than paying for three lgamma calls per point.
+template <class real, class Terms>
+real regularized_incomplete_beta(const Terms &terms, const Terms &swapped_terms,
+                                 const real log_inv_beta_fn, const real x, const bool upper) {
+  const real a = terms.a;
+  const real b = terms.b;
+  if (!(x > real{0.0} && x < real{1.0})) {
+    if (std::isnan(x)) {
+      return x;
+    }
+    return (x <= real{0.0}) == upper ? real{1.0} : real{0.0};
+  }
+
+  // Evaluate whichever of I_x(a, b) and I_{1-x}(b, a) = 1 - I_x(a, b) converges faster, and
+  // subtract from one only if the other tail was asked for
+  const real front = std::exp(a * std::log(x) + b * std::log1p(-x) + log_inv_beta_fn);
+  if (x < (a + real{1.0}) / (a + b + real{2.0})) {
+    const real tail = front * incomplete_beta_continued_fraction(terms, x) / a;
+    return upper ? real{1.0} - tail : tail;
+  }
+  const real tail = front * incomplete_beta_continued_fraction(swapped_terms, real{1.0} - x) / b;
+  return upper ? tail : real{1.0} - tail;
+}
+
+// log I_x(a, b), which stays finite where I_x(a, b) underflows. Where the continued fraction is
+// taken directly the whole expression is assembled in log space; in the other orientation
+// I_x(a, b) is at least about one half, so log1p of the complement loses nothing.
+template <class real, class Terms>
+real log_regularized_incomplete_beta(const Terms &terms, const Terms &swapped_terms,
+                                     const real log_inv_beta_fn, const real x) {
+  const real a = terms.a;
+  const real b = terms.b;
+  if (!(x > real{0.0} && x < real{1.0})) {
+    if (std::isnan(x)) {
+      return x;
+    }
+    return x <= real{0.0} ? -std::numeric_limits<real>::infinity() : real{0.0};
+  }
+
+  const real log_front = a * std::log(x) + b * std::log1p(-x) + log_inv_beta_fn;
+  if (x < (a + real{1.0}) / (a + b + real{2.0})) {
+    return log_front + std::log(incomplete_beta_continued_fraction(terms, x) / a);
+  }
+  const real tail =
+      std::exp(log_front) * incomplete_beta_continued_fraction(swapped_terms, real{1.0} - x) / b;
+  return std::log1p(-tail);
+}
+
+template <class real>
+real regularized_incomplete_beta(const real a, const real b, const real log_inv_beta_fn,
+                                 const real x) {
+  return regularized_incomplete_beta(IncompleteBetaTerms<real>{a, b},
+                                     IncompleteBetaTerms<real>{b, a}, log_inv_beta_fn, x, false);
+}
+
+template <class real> real regularized_incomplete_beta(const real a, const real b, const real x) {
+  return regularized_incomplete_beta(
+      a, b, std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b), x);
+}
+
+// I_x(a, b) for many x with the same a and b. Construction caches the parameter-dependent
+// constants, including the first partial numerators of the continued fraction in both
+// orientations, so each evaluation does one exp, two logs and no further setup.
+template <class real> class IncompleteBeta {
+private:
+  static constexpr int table_size = 32;
+
+  // Partial numerators looked up from a table for the first steps, which are all that moderate
+  // parameters need, and computed beyond it
+  struct TabulatedTerms {
+    real a;
+    real b;
+    std::array<real, table_size> even_table;
+    std::array<real, table_size> odd_table;
+
+    explicit TabulatedTerms(const IncompleteBetaTerms<real> terms) : a(terms.a), b(terms.b) {
+      for (int m = 0; m < table_size; ++m) {
+        even_table[m] = terms.even(m);
+        odd_table[m] = terms.odd(m);
+      }
+    }
+
+    real even(const int m) const {
+      return m < table_size ? even_table[m] : IncompleteBetaTerms<real>{a, b}.even(m);
+    }
+
+    real odd(const int m) const {
+      return m < table_size ? odd_table[m] : IncompleteBetaTerms<real>{a, b}.odd(m);
+    }
+  };
+
+  TabulatedTerms mTerms;
+  TabulatedTerms mSwappedTerms;
+  real mLogInvBetaFn;
+
+  IncompleteBeta(const TabulatedTerms &terms, const TabulatedTerms &swapped_terms,
+                 const real log_inv_beta_fn)
+      : mTerms(terms), mSwappedTerms(swapped_terms), mLogInvBetaFn(log_inv_beta_fn) {}
+
+  // The y in (0, 1/2] with log I_y(a, b) = log_p, given that log I_{1/2}(a, b) >= log_p. Newton's
+  // method on log I against log y, where the lower tail is close to the straight line
+  // a log y + log(1 / (a B(a, b))), started from that line. A step leaving the bracket known to
+  // hold the root is replaced by bisection in log y, so roots down to the smallest subnormal are
+  // reached in a bounded number of steps; smaller ones give zero.
+  real lower_inverse(const real log_p) const {
+    constexpr real eps = std::numeric_limits<real>::epsilon();
+    const real a = mTerms.a;
+    const real b = mTerms.b;
+
+    real lo = std::numeric_limits<real>::denorm_min();
+    real hi{0.5};
+    if (log(lo) > log_p) {
+      // The root is below the smallest subnormal and rounds to zero
+      return real{0.0};
+    }
+    real y = std::exp((log_p + std::log(a) - mLogInvBetaFn) / a);
+    y = std::clamp(y, lo, hi);
+    for (int i = 0; i < 400; ++i) {
+      const real log_cdf = log(y);
+      const real g = log_cdf - log_p;
+      if (g == real{0.0}) {
+        break;
+      }
+      (g < real{0.0} ? lo : hi) = y;
+
+      // d log I / d log y = y pdf(y) / I_y(a, b)
+      const real slope =
+          std::exp(a * std::log(y) + (b - real{1.0}) * std::log1p(-y) + mLogInvBetaFn - log_cdf);
+      real next = y * std::exp(-g / slope);
+      if (!(next > lo && next < hi)) {
+        next = std::sqrt(lo) * std::sqrt(hi);
+      }
+      if (std::fabs(next - y) <= eps * y) {
+        y = next;
+        break;
+      }
+      y = next;
+    }
+    return y;
+  }
+
+public:
+  IncompleteBeta(const real a, const real b, const real log_inv_beta_fn)
+      : mTerms(IncompleteBetaTerms<real>{a, b}), mSwappedTerms(IncompleteBetaTerms<real>{b, a}),
+        mLogInvBetaFn(log_inv_beta_fn) {}
+
+  IncompleteBeta(const real a, const real b)
+      : IncompleteBeta(a, b, std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b)) {}
+
+  // I_x(a, b)
+  real operator()(const real x) const {
+    return regularized_incomplete_beta(mTerms, mSwappedTerms, mLogInvBetaFn, x, false);
+  }
+
+  // 1 - I_x(a, b), without cancellation as I_x(a, b) approaches one
+  real complement(const real x) const {
+    return regularized_incomplete_beta(mTerms, mSwappedTerms, mLogInvBetaFn, x, true);
+  }
+
+  // log I_x(a, b), finite far below where I_x(a, b) underflows
+  real log(const real x) const {
+    return log_regularized_incomplete_beta(mTerms, mSwappedTerms, mLogInvBetaFn, x);
+  }
+
+  // I_x(b, a), sharing the cached tables
+  IncompleteBeta swapped() const { return IncompleteBeta{mSwappedTerms, mTerms, mLogInvBetaFn}; }
+
+  // The x with I_x(a, b) = p. A root below one half is solved for in the lower tail of I_x(a, b)
+  // and one above it in the lower tail of I_{1-x}(b, a), both in log space, so p far into either
+  // tail keeps its relative precision in x or 1 - x respectively.
+  real inverse(const real p) const {
+    if (!(p > real{0.0} && p < real{1.0})) {
+      if (p == real{0.0} || p == real{1.0}) {
+        return p;
+      }
+      return std::numeric_limits<real>::quiet_NaN();
+    }
+    if (p <= (*this)(real{0.5})) {
+      return lower_inverse(std::log(p));
+    }
+    return real{1.0} - swapped().lower_inverse(std::log1p(-p));
+  }
+
+  void operator()(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = (*this)(x[i]);
+    }
+  }
+
+  void complement(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = complement(x[i]);
+    }
+  }
+
+  void log(const real *x, real *out, const std::size_t n) const {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = log(x[i]);
+    }
+  }
+};
+
+} // namespace zoo
+
+#endif // ZOO_SPECIAL_FUNCTIONS_HPP_
@@ -24,8 +24,12 @@ SOFTWARE.
 
 #include "catch.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
 #include "continuous_univariate.hpp"
 #include "zoo_util.hpp"
@@ -50,6 +54,20 @@ TEMPLATE_TEST_CASE("Beta values", "[beta]", REAL_TYPES) {
   CHECK(dist.log_pdf(0.5) == Approx(TestType{0.3360859797527134507530L}).epsilon(e));
   CHECK(std::isinf(dist.log_pdf(2.0)));
 
+  // Batch PDF & Log PDF
+  const std::vector<TestType> xs = {-1.0, 0.5, 2.0};
+  std::vector<TestType> out(xs.size());
+
+  dist.pdf(xs.data(), out.data(), xs.size());
+  CHECK(out[0] == Approx(TestType{0.0L}).epsilon(e));
+  CHECK(out[1] == Approx(TestType{1.399459344806713569240L}).epsilon(e));
+  CHECK(out[2] == Approx(TestType{0.0L}).epsilon(e));
+
+  dist.log_pdf(xs.data(), out.data(), xs.size());
+  CHECK(std::isinf(out[0]));
+  CHECK(out[1] == Approx(TestType{0.3360859797527134507530L}).epsilon(e));
+  CHECK(std::isinf(out[2]));
+
   // Sample
   const TestType big_e{0.1};
   const std::size_t n = 10001;
@@ -83,6 +101,19 @@ TEMPLATE_TEST_CASE("Normal values", "[normal]", REAL_TYPES) {
   CHECK(dist.log_pdf(5.0) == Approx(TestType{-3.189465803587791871442L}).epsilon(e));
   CHECK(dist.log_pdf(9.6) == Approx(TestType{-1.798161455761704914921L}).epsilon(e));
 
+  // Batch PDF & Log PDF through the base class
+  zoo::ContinuousUnivariate<TestType> &base = dist;
+  const std::vector<TestType> xs = {5.0, 9.6};
+  std::vector<TestType> out(xs.size());
+
+  base.pdf(xs.data(), out.data(), xs.size());
+  CHECK(out[0] == Approx(TestType{0.04119387068037555522332L}).epsilon(e));
+  CHECK(out[1] == Approx(TestType{0.1656030770867795793562L}).epsilon(e));
+
+  base.log_pdf(xs.data(), out.data(), xs.size());
+  CHECK(out[0] == Approx(TestType{-3.189465803587791871442L}).epsilon(e));
+  CHECK(out[1] == Approx(TestType{-1.798161455761704914921L}).epsilon(e));
+
   // Sample
   const TestType big_e{0.1};
   const std::size_t n = 10001;
@@ -94,4 +125,864 @@ TEMPLATE_TEST_CASE("Normal values", "[normal]", REAL_TYPES) {
 
   const auto median = zoo::median(sample);
   CHECK(median == Approx(dist_mean).epsilon(big_e));
+
+  // Refilling an existing buffer reuses its storage
+  const auto *const storage = sample.data();
+  dist.randn_into(sample, n / 2);
+  CHECK(sample.size() == n / 2);
+  CHECK(sample.data() == storage);
+
+  const auto [refill_mean, refill_var] = zoo::moments(sample);
+  CHECK(refill_mean == Approx(dist_mean).epsilon(big_e));
+  CHECK(refill_var == Approx(dist_std_dev * dist_std_dev).epsilon(big_e));
+}
+
+TEMPLATE_TEST_CASE("Normal SIMD kernels", "[normal][simd]", REAL_TYPES) {
+
+  const TestType e = std::numeric_limits<TestType>::epsilon() * 1000;
+
+  const TestType dist_mean{-1.7L};
+  const TestType dist_std_dev{0.8L};
+  zoo::Normal<TestType> dist{dist_mean, dist_std_dev};
+
+  // An odd length exercises the partial final vector
+  std::vector<TestType> xs(103);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = dist_mean + dist_std_dev * TestType(-10.0 + 0.2 * static_cast<double>(i));
+  }
+  std::vector<TestType> out(xs.size());
+
+  for (const auto isa : {zoo::simd::Isa::Scalar, zoo::simd::Isa::Sse2, zoo::simd::Isa::Avx2,
+                         zoo::simd::Isa::Avx512}) {
+    zoo::simd::set_max_isa(isa);
+
+    dist.pdf(xs.data(), out.data(), xs.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      CHECK(out[i] == Approx(dist.pdf(xs[i])).epsilon(e));
+    }
+
+    dist.log_pdf(xs.data(), out.data(), xs.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      CHECK(out[i] == Approx(dist.log_pdf(xs[i])).epsilon(e));
+    }
+  }
+  zoo::simd::set_max_isa(zoo::simd::Isa::Avx512);
+}
+
+TEMPLATE_TEST_CASE("Beta SIMD kernels", "[beta][simd]", REAL_TYPES) {
+
+  const TestType e = std::numeric_limits<TestType>::epsilon() * 1000;
+
+  // Points outside, on the edge of, and deep inside the support, including subnormals
+  std::vector<TestType> xs = {TestType{-0.5},
+                              TestType{0.0},
+                              std::numeric_limits<TestType>::denorm_min() * 3,
+                              std::numeric_limits<TestType>::min() / 7,
+                              TestType{1e-20},
+                              TestType{1.0},
+                              TestType{2.0},
+                              std::numeric_limits<TestType>::quiet_NaN()};
+  for (int i = 1; i < 100; ++i) {
+    xs.push_back(TestType(0.01 * i));
+  }
+  std::vector<TestType> out(xs.size());
+
+  for (const auto &[alpha, beta] : {std::pair{0.4, 0.7}, std::pair{2.6, 4.9}, std::pair{1.0, 3.0}}) {
+    zoo::Beta<TestType> dist{TestType(alpha), TestType(beta)};
+
+    for (const auto isa : {zoo::simd::Isa::Scalar, zoo::simd::Isa::Sse2, zoo::simd::Isa::Avx2,
+                           zoo::simd::Isa::Avx512}) {
+      zoo::simd::set_max_isa(isa);
+
+      dist.log_pdf(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        const TestType expected = dist.log_pdf(xs[i]);
+        if (std::isinf(expected)) {
+          CHECK(out[i] == expected);
+        } else {
+          CHECK(out[i] == Approx(expected).epsilon(e));
+        }
+      }
+
+      dist.pdf(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        // Densities that only exist as subnormals are flushed to zero by the vector exp
+        const TestType expected = dist.pdf(xs[i]);
+        if (expected > std::numeric_limits<TestType>::min()) {
+          CHECK(out[i] == Approx(expected).epsilon(e));
+        } else {
+          CHECK(out[i] == Approx(expected).margin(std::numeric_limits<TestType>::min()));
+        }
+      }
+    }
+  }
+  zoo::simd::set_max_isa(zoo::simd::Isa::Avx512);
+}
+
+TEMPLATE_TEST_CASE("Cumulative distribution functions", "[normal][beta][cdf]", REAL_TYPES) {
+
+  // Approx compares in double, which rounds away part of the long double precision
+  const TestType e = std::max<TestType>(std::numeric_limits<TestType>::epsilon(),
+                                        std::numeric_limits<double>::epsilon()) *
+                     1000;
+  const TestType inf = std::numeric_limits<TestType>::infinity();
+  const TestType nan = std::numeric_limits<TestType>::quiet_NaN();
+  const auto isas = {zoo::simd::Isa::Scalar, zoo::simd::Isa::Sse2, zoo::simd::Isa::Avx2,
+                     zoo::simd::Isa::Avx512};
+
+  SECTION("Normal") {
+    const TestType dist_mean{-1.7L};
+    const TestType dist_std_dev{0.8L};
+    zoo::Normal<TestType> dist{dist_mean, dist_std_dev};
+
+    // Far tails, infinities and NaN, then an odd-length grid for the partial final vector
+    std::vector<TestType> xs = {-inf, inf, nan, dist_mean - 40 * dist_std_dev,
+                                dist_mean + 40 * dist_std_dev};
+    for (int i = 0; i < 97; ++i) {
+      xs.push_back(dist_mean + dist_std_dev * TestType(-12.0 + 0.25 * i));
+    }
+    std::vector<TestType> out(xs.size());
+
+    const auto check = [&](const TestType actual, const TestType expected) {
+      if (std::isnan(expected)) {
+        CHECK(std::isnan(actual));
+      } else if (std::isinf(expected) || expected == TestType{0.0}) {
+        CHECK(actual == expected);
+      } else if (std::fabs(expected) > std::numeric_limits<TestType>::min()) {
+        CHECK(actual == Approx(expected).epsilon(e));
+      } else {
+        CHECK(actual == Approx(expected).margin(std::numeric_limits<TestType>::min()));
+      }
+    };
+
+    for (const auto isa : isas) {
+      zoo::simd::set_max_isa(isa);
+
+      dist.cdf(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        check(out[i], dist.cdf(xs[i]));
+      }
+
+      dist.survival(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        check(out[i], dist.survival(xs[i]));
+      }
+
+      dist.log_cdf(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        check(out[i], dist.log_cdf(xs[i]));
+      }
+    }
+
+    CHECK(dist.cdf(-inf) == TestType{0.0});
+    CHECK(dist.cdf(inf) == TestType{1.0});
+    CHECK(dist.cdf(dist_mean) == Approx(TestType{0.5}).epsilon(e));
+    CHECK(dist.survival(dist_mean + 5 * dist_std_dev) ==
+          Approx(TestType{2.8665157187919391e-7L}).epsilon(e));
+    CHECK(dist.log_cdf(dist_mean - 5 * dist_std_dev) ==
+          Approx(TestType{-15.064998393988724L}).epsilon(e));
+
+    // Far below the point where the cdf itself underflows
+    CHECK(dist.log_cdf(dist_mean - 40 * dist_std_dev) ==
+          Approx(TestType{-804.6084420137538L}).epsilon(e));
+
+    std::vector<TestType> ps = {TestType{0.0}, TestType{1.0}, TestType{-0.5},
+                                TestType{1.5}, nan,           TestType{1e-30L},
+                                TestType{1.0} - std::numeric_limits<TestType>::epsilon()};
+    for (int i = 1; i < 100; ++i) {
+      ps.push_back(TestType(0.01 * i));
+    }
+
+    out.resize(ps.size());
+    for (const auto isa : isas) {
+      zoo::simd::set_max_isa(isa);
+
+      dist.quantile(ps.data(), out.data(), ps.size());
+      for (std::size_t i = 0; i < ps.size(); ++i) {
+        check(out[i], dist.quantile(ps[i]));
+      }
+    }
+
+    CHECK(dist.quantile(TestType{0.0}) == -inf);
+    CHECK(dist.quantile(TestType{1.0}) == inf);
+    CHECK(std::isnan(dist.quantile(TestType{1.5})));
+    CHECK(zoo::Normal<TestType>{}.quantile(TestType{0.975L}) ==
+          Approx(TestType{1.9599639845400542355L}).epsilon(e));
+    for (std::size_t i = 5; i < ps.size(); ++i) {
+      CHECK(dist.cdf(dist.quantile(ps[i])) == Approx(ps[i]).epsilon(e));
+    }
+  }
+
+  SECTION("Beta") {
+    // The Beta(2, 3) cdf has the closed form 6x^2 - 8x^3 + 3x^4
+    zoo::Beta<TestType> dist{TestType{2.0}, TestType{3.0}};
+    for (int i = 0; i <= 100; ++i) {
+      const TestType x = TestType(0.01 * i);
+      const TestType expected = x * x * (6 - 8 * x + 3 * x * x);
+      CHECK(dist.cdf(x) == Approx(expected).margin(e));
+      CHECK(dist.survival(x) == Approx(1 - expected).margin(e));
+    }
+    CHECK(dist.cdf(TestType{-0.5}) == TestType{0.0});
+    CHECK(dist.cdf(TestType{1.5}) == TestType{1.0});
+    CHECK(dist.survival(TestType{-0.5}) == TestType{1.0});
+    CHECK(std::isnan(dist.cdf(nan)));
+    CHECK(dist.log_cdf(TestType{0.25}) == Approx(std::log(dist.cdf(TestType{0.25}))).epsilon(e));
+
+    // Deep in the left tail the cdf underflows but log_cdf does not. Beta(a, 2) has the closed
+    // form cdf x^a (a + 1 - a x), so log_cdf = a log x + log(a + 1 - a x).
+    {
+      zoo::Beta<TestType> steep{TestType{50.0}, TestType{2.0}};
+      // x^50 for the second point is below the smallest subnormal of each type
+      const long double denorm_min = std::numeric_limits<TestType>::denorm_min();
+      const auto underflow = TestType(std::pow(denorm_min, 0.02L) / 4);
+      const std::vector<TestType> xs = {TestType{1e-10L}, underflow, TestType{1e-3L}};
+      std::vector<TestType> out(xs.size());
+      steep.log_cdf(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        const long double x = xs[i];
+        const long double expected = 50 * std::log(x) + std::log(51 - 50 * x);
+        CHECK(std::isfinite(steep.log_cdf(xs[i])));
+        CHECK(steep.log_cdf(xs[i]) == Approx(expected).epsilon(e));
+        CHECK(out[i] == Approx(expected).epsilon(e));
+      }
+      CHECK(steep.cdf(underflow) == TestType{0.0});
+    }
+
+    for (const auto &[alpha, beta] :
+         {std::pair{0.4, 0.7}, std::pair{2.6, 4.9}, std::pair{1.0, 3.0}, std::pair{12.0, 1.5}}) {
+      zoo::Beta<TestType> d{TestType(alpha), TestType(beta)};
+
+      // Swapping the parameters reflects the distribution about one half
+      zoo::Beta<TestType> reflected{TestType(beta), TestType(alpha)};
+      for (int i = 1; i < 100; ++i) {
+        const TestType x = TestType(0.01 * i);
+        CHECK(d.cdf(x) + d.survival(x) == Approx(TestType{1.0}).epsilon(e));
+        CHECK(d.survival(x) == Approx(reflected.cdf(1 - x)).epsilon(e));
+      }
+
+      std::vector<TestType> ps;
+      for (int i = 1; i < 100; ++i) {
+        ps.push_back(TestType(0.01 * i));
+      }
+      std::vector<TestType> qs(ps.size());
+      d.quantile(ps.data(), qs.data(), ps.size());
+      for (std::size_t i = 0; i < ps.size(); ++i) {
+        CHECK(qs[i] > TestType{0.0});
+        CHECK(qs[i] < TestType{1.0});
+        CHECK(d.cdf(qs[i]) == Approx(ps[i]).epsilon(e));
+      }
+      CHECK(d.quantile(TestType{0.0}) == TestType{0.0});
+      CHECK(d.quantile(TestType{1.0}) == TestType{1.0});
+      CHECK(std::isnan(d.quantile(TestType{-0.1})));
+    }
+
+    // Quantiles far into both tails, including shapes with a pole at zero
+    for (const auto &[alpha, beta] : {std::pair{0.05, 0.05}, std::pair{0.01, 5.0},
+                                      std::pair{0.4, 0.7}, std::pair{50.0, 2.0}}) {
+      zoo::Beta<TestType> d{TestType(alpha), TestType(beta)};
+
+      // The relative error in p grows with the slope of log cdf against log x, up to alpha
+      const auto margin = static_cast<double>(e) * (1.0 + alpha + beta);
+      for (const long double p : {1e-10L, 1e-30L, 1e-300L}) {
+        if (p < std::numeric_limits<TestType>::min()) {
+          continue;
+        }
+        const TestType x = d.quantile(TestType(p));
+        if (x == TestType{0.0}) {
+          // Only where the quantile is below the smallest subnormal
+          CHECK(d.log_cdf(std::numeric_limits<TestType>::denorm_min()) > std::log(TestType(p)));
+        } else {
+          CHECK(static_cast<double>(d.log_cdf(x) - std::log(TestType(p))) ==
+                Approx(0.0).margin(margin));
+        }
+      }
+
+      // 1 - q is exact in every type, and the upper tail is solved for through 1 - x
+      zoo::Beta<TestType> reflected{TestType(beta), TestType(alpha)};
+      for (const int shift : {10, 20}) {
+        const TestType q = std::ldexp(TestType{1.0}, -shift);
+        const TestType x = d.quantile(1 - q);
+        if (x == TestType{1.0}) {
+          // Only where 1 - x is below the spacing of the reals just under one
+          CHECK(reflected.quantile(q) < std::numeric_limits<TestType>::epsilon());
+        } else {
+          // Rounding x near one costs 1 - x a relative precision of about eps / (1 - x)
+          CHECK(static_cast<double>(std::log(d.survival(x)) - std::log(q)) ==
+                Approx(0.0).margin(margin / static_cast<double>(1 - x)));
+        }
+      }
+    }
+  }
+
+  SECTION("Incomplete beta evaluator") {
+    std::vector<TestType> xs = {TestType{-0.5}, TestType{0.0}, TestType{1.0}, TestType{2.0}, nan};
+    for (int i = 1; i < 200; ++i) {
+      xs.push_back(TestType(0.005 * i));
+    }
+    std::vector<TestType> out(xs.size());
+
+    // Large parameters run the continued fraction past its tabulated terms
+    for (const auto &[alpha, beta] :
+         {std::pair{0.4, 0.7}, std::pair{2.6, 4.9}, std::pair{150.0, 200.0}}) {
+      const zoo::StaticBeta<TestType> d{TestType(alpha), TestType(beta)};
+      const zoo::IncompleteBeta<TestType> fn = d.incomplete_beta();
+
+      // Rounding in the terms of the log prefactor grows with the parameters
+      const TestType tolerance = e * TestType(1.0 + (alpha + beta) / 100.0);
+      const auto check = [&](const TestType actual, const TestType expected) {
+        if (std::isnan(expected)) {
+          CHECK(std::isnan(actual));
+        } else {
+          CHECK(actual == Approx(expected).epsilon(tolerance).margin(
+                              std::numeric_limits<TestType>::min()));
+        }
+      };
+
+      d.cdf(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        check(out[i], d.cdf(xs[i]));
+        check(fn(xs[i]), d.cdf(xs[i]));
+        check(out[i], zoo::regularized_incomplete_beta(d.alpha(), d.beta(), xs[i]));
+      }
+
+      d.survival(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        check(out[i], d.survival(xs[i]));
+        check(fn.complement(xs[i]), d.survival(xs[i]));
+      }
+
+      d.log_cdf(xs.data(), out.data(), xs.size());
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        if (xs[i] <= TestType{0.0}) {
+          CHECK(out[i] == -std::numeric_limits<TestType>::infinity());
+        } else {
+          check(out[i], d.log_cdf(xs[i]));
+        }
+      }
+    }
+
+    // Symmetric about one half, and evaluated there through the reflected continued fraction
+    const zoo::IncompleteBeta<TestType> symmetric{TestType{200.0}, TestType{200.0}};
+    CHECK(symmetric(TestType{0.5}) == Approx(TestType{0.5}).epsilon(e));
+    CHECK(symmetric(TestType{0.45}) == Approx(symmetric.complement(TestType{0.55})).epsilon(e));
+  }
+  zoo::simd::set_max_isa(zoo::simd::Isa::Avx512);
+}
+
+TEMPLATE_TEST_CASE("Structure-of-arrays batches", "[normal][beta][simd]", REAL_TYPES) {
+
+  const TestType e = std::numeric_limits<TestType>::epsilon() * 1000;
+
+  // An odd length exercises the partial final vector
+  const std::size_t n = 37;
+  std::vector<TestType> loc(n);
+  std::vector<TestType> scale(n);
+  std::vector<TestType> xs(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    loc[i] = TestType(-2.0 + 0.1 * static_cast<double>(i));
+    scale[i] = TestType(0.5 + 0.05 * static_cast<double>(i));
+    xs[i] = TestType(0.02 + 0.025 * static_cast<double>(i));
+  }
+  xs[n - 1] = TestType{1.5};
+
+  zoo::NormalBatch<TestType> normals{loc.data(), scale.data(), n};
+  zoo::BetaBatch<TestType> betas;
+  for (std::size_t i = 0; i < n; ++i) {
+    betas.push_back(scale[i], scale[n - 1 - i]);
+  }
+  REQUIRE(normals.size() == n);
+  REQUIRE(betas.size() == n);
+
+  std::vector<TestType> out(n);
+  for (const auto isa : {zoo::simd::Isa::Scalar, zoo::simd::Isa::Sse2, zoo::simd::Isa::Avx2,
+                         zoo::simd::Isa::Avx512}) {
+    zoo::simd::set_max_isa(isa);
+
+    normals.log_pdf(xs.data(), out.data());
+    for (std::size_t i = 0; i < n; ++i) {
+      CHECK(out[i] == Approx(normals[i].log_pdf(xs[i])).epsilon(e));
+    }
+    normals.pdf(xs.data(), out.data());
+    for (std::size_t i = 0; i < n; ++i) {
+      CHECK(out[i] == Approx(normals[i].pdf(xs[i])).epsilon(e));
+    }
+    normals.log_pdf(xs[3], out.data());
+    for (std::size_t i = 0; i < n; ++i) {
+      CHECK(out[i] == Approx(normals[i].log_pdf(xs[3])).epsilon(e));
+    }
+
+    betas.log_pdf(xs.data(), out.data());
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+      CHECK(out[i] == Approx(betas[i].log_pdf(xs[i])).epsilon(e));
+    }
+    CHECK(out[n - 1] == -std::numeric_limits<TestType>::infinity());
+    betas.pdf(xs[5], out.data());
+    for (std::size_t i = 0; i < n; ++i) {
+      CHECK(out[i] == Approx(betas[i].pdf(xs[5])).epsilon(e));
+    }
+  }
+  zoo::simd::set_max_isa(zoo::simd::Isa::Avx512);
+
+  // Updating an entry recomputes its constants
+  normals.set(2, TestType{1.0}, TestType{3.0});
+  normals.log_pdf(xs.data(), out.data());
+  CHECK(normals.mean(2) == TestType{1.0});
+  CHECK(out[2] == Approx(zoo::StaticNormal<TestType>(TestType{1.0}, TestType{3.0}).log_pdf(xs[2])));
+
+  // Each entry is sampled from its own parameters
+  std::mt19937 engine{17};
+  betas.rand(engine, out.data());
+  for (const auto draw : out) {
+    CHECK(draw > TestType{0.0});
+    CHECK(draw < TestType{1.0});
+  }
+}
+
+TEMPLATE_TEST_CASE("Log likelihood", "[likelihood]", REAL_TYPES) {
+
+  // Spans several blocks, with a partial final block and chunk
+  zoo::Normal<TestType> normal{TestType{0.5}, TestType{2.0}, 23u};
+  const std::vector<TestType> data = normal.randn(3 * zoo::log_likelihood_block_size + 1001);
+
+  long double expected = 0.0L;
+  for (const auto x : data) {
+    expected += static_cast<long double>(normal.log_pdf(x));
+  }
+
+  // The reference is a plain long double sum, which limits how closely long double can match it
+  const TestType single = zoo::log_likelihood(normal, data);
+  const double e = std::max(double(std::numeric_limits<TestType>::epsilon()) * 100.0, 1e-14);
+  CHECK(single == Approx(expected).epsilon(e));
+
+  // The static distribution gives the same sum, for any number of threads
+  const zoo::StaticNormal<TestType> static_normal{TestType{0.5}, TestType{2.0}};
+  for (const unsigned n_threads : {1u, 2u, 3u, 8u}) {
+    CHECK(zoo::log_likelihood(static_normal, data, n_threads) == single);
+  }
+
+  // Points outside the support give -inf rather than NaN
+  zoo::Beta<TestType> beta{TestType{2.0}, TestType{3.0}};
+  const std::vector<TestType> beta_data = {TestType{0.2}, TestType{1.5}, TestType{0.7}};
+  CHECK(zoo::log_likelihood(beta, beta_data) == -std::numeric_limits<TestType>::infinity());
+  CHECK(zoo::log_likelihood(beta, beta_data.data(), 0) == TestType{0.0});
+}
+
+TEMPLATE_TEST_CASE("Pluggable engines", "[engine]", REAL_TYPES) {
+
+  // Identically seeded engines give identical samples
+  using Normal = zoo::Normal<TestType, std::minstd_rand>;
+  Normal normal_a{TestType{1.0}, TestType{2.0}, std::minstd_rand{42}};
+  Normal normal_b{TestType{1.0}, TestType{2.0}, std::minstd_rand{42}};
+  CHECK(normal_a.randn(101) == normal_b.randn(101));
+
+  zoo::Beta<TestType, std::mt19937_64> beta_a{TestType{2.0}, TestType{3.0}, std::mt19937_64{7}};
+  zoo::Beta<TestType, std::mt19937_64> beta_b{TestType{2.0}, TestType{3.0}, std::mt19937_64{7}};
+  CHECK(beta_a.randn(101) == beta_b.randn(101));
+
+  // Seeding through the constructor is reproducible too
+  zoo::Normal<TestType, zoo::Philox4x32> seeded_a{TestType{0.0}, TestType{1.0}, 11u};
+  zoo::Normal<TestType, zoo::Philox4x32> seeded_b{TestType{0.0}, TestType{1.0}, 11u};
+  CHECK(seeded_a.randn(11) == seeded_b.randn(11));
+
+  // The engine can be reseeded in place through the base class
+  zoo::ContinuousUnivariate<TestType, std::mt19937_64> &base = beta_a;
+  base.engine().seed(7);
+  beta_b.engine().seed(7);
+  CHECK(base.rand() == beta_b.rand());
+}
+
+// Generic code over any static distribution; the calls resolve at compile time
+template <class Dist, class real = typename Dist::real_type>
+real sum_log_pdf(const Dist &dist, const std::vector<real> &x) {
+  real sum{0.0};
+  for (const auto xi : x) {
+    sum += dist.log_pdf(xi);
+  }
+  return sum;
+}
+
+TEMPLATE_TEST_CASE("Static distributions", "[static]", REAL_TYPES) {
+
+  CHECK_FALSE(std::is_polymorphic_v<zoo::StaticNormal<TestType>>);
+  CHECK_FALSE(std::is_polymorphic_v<zoo::StaticBeta<TestType>>);
+
+  // Parameter-only: no engine and no vtable, just the cached constants
+  CHECK(sizeof(zoo::StaticNormal<TestType>) == 5 * sizeof(TestType));
+  CHECK(sizeof(zoo::StaticBeta<TestType>) == 4 * sizeof(TestType));
+
+  const zoo::StaticNormal<TestType> static_normal{TestType{1.0}, TestType{2.0}};
+  zoo::Normal<TestType> normal{TestType{1.0}, TestType{2.0}};
+  const zoo::StaticBeta<TestType> static_beta{TestType{2.0}, TestType{3.0}};
+  zoo::Beta<TestType> beta{TestType{2.0}, TestType{3.0}};
+
+  // The virtual classes are adapters over the static ones, so values agree exactly
+  const std::vector<TestType> x = {TestType{0.1}, TestType{0.5}, TestType{0.9}};
+  TestType expected_normal{0.0};
+  TestType expected_beta{0.0};
+  for (const auto xi : x) {
+    CHECK(static_normal.pdf(xi) == normal.pdf(xi));
+    CHECK(static_beta.pdf(xi) == beta.pdf(xi));
+    expected_normal += normal.log_pdf(xi);
+    expected_beta += beta.log_pdf(xi);
+  }
+  CHECK(sum_log_pdf(static_normal, x) == expected_normal);
+  CHECK(sum_log_pdf(static_beta, x) == expected_beta);
+
+  std::vector<TestType> out(x.size());
+  static_beta.log_pdf(x.data(), out.data(), x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    CHECK(out[i] == Approx(static_beta.log_pdf(x[i])));
+  }
+
+  // Draws with the same engine match the adapter's
+  std::mt19937 engine{5};
+  normal.engine().seed(5);
+  CHECK(static_normal.randn(engine, 101) == normal.randn(101));
+  CHECK(static_normal.rand(engine) == normal.rand());
+
+  engine.seed(9);
+  beta.engine().seed(9);
+  CHECK(static_beta.randn(engine, 101) == beta.randn(101));
+  CHECK(beta.distribution().alpha() == TestType{2.0});
+  CHECK(beta.distribution().beta() == TestType{3.0});
+  CHECK(normal.distribution().mean() == TestType{1.0});
+  CHECK(normal.distribution().std_dev() == TestType{2.0});
+}
+
+TEMPLATE_TEST_CASE("Reparameterisation", "[static][params]", REAL_TYPES) {
+
+  const std::vector<TestType> x = {TestType{-0.5}, TestType{0.1}, TestType{0.5}, TestType{0.9}};
+
+  // In place, the constants match a fresh construction exactly
+  zoo::StaticNormal<TestType> static_normal{TestType{1.0}, TestType{2.0}};
+  static_normal.set_params(TestType{-0.3L}, TestType{0.7L});
+  const zoo::StaticNormal<TestType> fresh_normal{TestType{-0.3L}, TestType{0.7L}};
+  CHECK(static_normal.mean() == fresh_normal.mean());
+  CHECK(static_normal.std_dev() == fresh_normal.std_dev());
+
+  zoo::StaticBeta<TestType> static_beta{TestType{2.0}, TestType{3.0}};
+  static_beta.set_params(TestType{0.6L}, TestType{4.5L});
+  const zoo::StaticBeta<TestType> fresh_beta{TestType{0.6L}, TestType{4.5L}};
+  CHECK(static_beta.alpha() == fresh_beta.alpha());
+  CHECK(static_beta.beta() == fresh_beta.beta());
+
+  for (const auto xi : x) {
+    CHECK(static_normal.pdf(xi) == fresh_normal.pdf(xi));
+    CHECK(static_normal.log_pdf(xi) == fresh_normal.log_pdf(xi));
+    CHECK(static_beta.pdf(xi) == fresh_beta.pdf(xi));
+    CHECK(static_beta.log_pdf(xi) == fresh_beta.log_pdf(xi));
+    CHECK(static_beta.cdf(xi) == fresh_beta.cdf(xi));
+  }
+
+  // The reciprocal beta function stays finite where tgamma(alpha + beta) overflows
+  const TestType alpha = std::is_same_v<TestType, float> ? TestType{20.0} : TestType{150.0};
+  const zoo::StaticBeta<TestType> large{alpha, TestType{1.5} * alpha};
+  const TestType e = std::numeric_limits<TestType>::epsilon() * 1000;
+  CHECK(std::isfinite(large.pdf(TestType{0.4L})));
+  CHECK(std::log(large.pdf(TestType{0.4L})) == Approx(large.log_pdf(TestType{0.4L})).epsilon(e));
+
+  // The virtual classes keep their engine, mid-stream, and draw with the new parameters
+  zoo::Normal<TestType> normal{TestType{0.0}, TestType{1.0}, std::uint64_t{21}};
+  normal.randn(7);
+  std::mt19937 engine = normal.engine();
+  normal.set_params(TestType{-0.3L}, TestType{0.7L});
+  CHECK(normal.engine() == engine);
+  CHECK(normal.distribution().mean() == TestType{-0.3L});
+  CHECK(normal.pdf(TestType{0.5}) == fresh_normal.pdf(TestType{0.5}));
+  CHECK(normal.rand() == fresh_normal.rand(engine));
+
+  zoo::Beta<TestType> beta{TestType{2.0}, TestType{3.0}, std::uint64_t{22}};
+  beta.randn(7);
+  engine = beta.engine();
+  beta.set_params(TestType{0.6L}, TestType{4.5L});
+  CHECK(beta.engine() == engine);
+  CHECK(beta.sampler().method() ==
+        zoo::BetaSampler<TestType>{TestType{0.6L}, TestType{4.5L}}.method());
+  CHECK(beta.pdf(TestType{0.5}) == fresh_beta.pdf(TestType{0.5}));
+  CHECK(beta.randn(11) == fresh_beta.randn(engine, 11));
+
+  // Inverse-cdf mode is kept, with a table for the new parameters
+  const TestType u_resolution =
+      std::max(TestType{1e-10L}, TestType{512.0} * std::numeric_limits<TestType>::epsilon());
+  beta.use_inverse_cdf(u_resolution);
+  beta.set_params(TestType{2.6L}, TestType{4.9L});
+  CHECK(beta.uses_inverse_cdf());
+  engine = beta.engine();
+  const zoo::InverseCdfSampler<TestType> table{zoo::StaticBeta<TestType>{TestType{2.6L},
+                                                                         TestType{4.9L}},
+                                               u_resolution};
+  CHECK(beta.rand() == table(engine));
+}
+
+TEMPLATE_TEST_CASE("Distribution sets", "[set]", REAL_TYPES) {
+
+  using Normal = zoo::StaticNormal<TestType>;
+  using Beta = zoo::StaticBeta<TestType>;
+
+  using Set = zoo::DistributionSet<Normal, Beta>;
+  Set set;
+  CHECK(set.empty());
+
+  // Interleave the types, adding some through the variant
+  CHECK(set.push_back(Normal{TestType{0.0}, TestType{1.0}}) == 0u);
+  CHECK(set.push_back(Beta{TestType{2.0}, TestType{3.0}}) == 1u);
+  CHECK(set.push_back(Normal{TestType{-1.0}, TestType{0.5}}) == 2u);
+  CHECK(set.push_back(typename Set::value_type{Beta{}}) == 3u);
+  CHECK(set.size() == 4u);
+  CHECK(set.template entries<Normal>().size() == 2u);
+  CHECK(set.template entries<Beta>().size() == 2u);
+
+  CHECK(std::get<Normal>(set[2]).mean() == TestType{-1.0});
+  CHECK(std::get<Beta>(set[1]).beta() == TestType{3.0});
+
+  // Results are written in entry order
+  const std::vector<TestType> x = {TestType{0.3}, TestType{0.4}, TestType{-0.8}, TestType{0.6}};
+  std::vector<TestType> log_pdf(x.size());
+  std::vector<TestType> pdf(x.size());
+  set.log_pdf(x.data(), log_pdf.data());
+  set.pdf(x.data(), pdf.data());
+
+  TestType sum{0.0};
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    const TestType expected = std::visit([&](const auto &d) { return d.log_pdf(x[i]); }, set[i]);
+    CHECK(log_pdf[i] == expected);
+    CHECK(pdf[i] == std::visit([&](const auto &d) { return d.pdf(x[i]); }, set[i]));
+    sum += expected;
+  }
+  CHECK(set.log_pdf_sum(x.data()) == Approx(sum));
+
+  // Draws are reproducible and each lands in its entry's support
+  std::vector<TestType> draws_a(set.size());
+  std::vector<TestType> draws_b(set.size());
+  std::mt19937 engine_a{3};
+  std::mt19937 engine_b{3};
+  set.rand(engine_a, draws_a.data());
+  set.rand(engine_b, draws_b.data());
+  CHECK(draws_a == draws_b);
+  CHECK(draws_a[1] > TestType{0.0});
+  CHECK(draws_a[1] < TestType{1.0});
+}
+
+TEMPLATE_TEST_CASE("Parallel sampling", "[parallel]", REAL_TYPES) {
+
+  // Several blocks, the last one partial
+  const std::size_t n = 2 * zoo::Normal<TestType>::parallel_block_size + 17;
+
+  using Normal = zoo::Normal<TestType, zoo::Philox4x32>;
+  Normal normal_1{TestType{3.0}, TestType{0.5}, zoo::Philox4x32{1u}};
+  Normal normal_4{TestType{3.0}, TestType{0.5}, zoo::Philox4x32{1u}};
+  const auto normal_sample = normal_1.randn_parallel(n, 1);
+  CHECK(normal_sample == normal_4.randn_parallel(n, 4));
+
+  const auto [mean, var] = zoo::moments(normal_sample);
+  CHECK(mean == Approx(TestType{3.0}).epsilon(0.01));
+  CHECK(var == Approx(TestType{0.25}).epsilon(0.01));
+
+  zoo::Beta<TestType> beta_1{TestType{2.0}, TestType{5.0}, std::mt19937{2u}};
+  zoo::Beta<TestType> beta_3{TestType{2.0}, TestType{5.0}, std::mt19937{2u}};
+  CHECK(beta_1.randn_parallel(n, 1) == beta_3.randn_parallel(n, 3));
+
+  // Each call advances the member engine, so consecutive calls differ
+  CHECK(beta_1.randn_parallel(100, 2) != beta_1.randn_parallel(100, 2));
+}
+
+TEMPLATE_TEST_CASE("Normal ziggurat sampler", "[normal][ziggurat]", REAL_TYPES) {
+
+  // The layers tile the density down to the axis
+  const auto &tables = zoo::NormalZiggurat<TestType>::tables();
+  CHECK(tables.x[1] == Approx(TestType{3.6541528853610088L}));
+  CHECK(tables.x[255] > TestType{0.0});
+  CHECK(tables.x[256] == TestType{0.0});
+
+  // Empirical CDF, including the tail beyond the base layer, matches the standard normal
+  zoo::Normal<TestType, zoo::Philox4x32> dist{TestType{0.0}, TestType{1.0}, zoo::Philox4x32{8u}};
+  const std::size_t n = 200000;
+  const auto sample = dist.randn(n);
+
+  for (const double z : {-4.0, -2.5, -1.0, 0.0, 0.3, 1.7, 3.0, 3.8}) {
+    const auto below = std::count_if(sample.begin(), sample.end(),
+                                     [z](const TestType x) { return x < TestType(z); });
+    const double expected = 0.5 * std::erfc(-z / std::sqrt(2.0));
+    CHECK(static_cast<double>(below) / n == Approx(expected).margin(0.003));
+  }
+}
+
+TEMPLATE_TEST_CASE("Beta samplers", "[beta][sampler]", REAL_TYPES) {
+
+  using Method = typename zoo::BetaSampler<TestType>::Method;
+
+  // Both orderings of each regime, since draws are mapped back differently when alpha > beta
+  const std::vector<std::tuple<double, double, Method>> cases = {
+      {0.3, 0.6, Method::Johnk},   {0.9, 0.05, Method::Johnk},  {0.5, 3.0, Method::ChengBC},
+      {3.0, 0.5, Method::ChengBC}, {1.0, 1.0, Method::ChengBC}, {2.0, 7.5, Method::ChengBB},
+      {40.0, 3.5, Method::ChengBB}};
+
+  const std::size_t n = 40000;
+  std::uint64_t seed = 0u;
+  for (const auto &[a, b, method] : cases) {
+    const TestType alpha = TestType(a);
+    const TestType beta = TestType(b);
+    zoo::Beta<TestType, zoo::Philox4x32> dist{alpha, beta, zoo::Philox4x32{++seed}};
+    CHECK(dist.sampler().method() == method);
+
+    const auto sample = dist.randn(n);
+    CHECK(std::all_of(sample.begin(), sample.end(),
+                      [](const TestType x) { return x >= TestType{0.0} && x <= TestType{1.0}; }));
+
+    const auto [mean, var] = zoo::moments(sample);
+    const TestType hand_mean = alpha / (alpha + beta);
+    const TestType hand_var =
+        alpha * beta / ((alpha + beta) * (alpha + beta) * (alpha + beta + TestType{1.0}));
+    CHECK(mean == Approx(hand_mean).margin(0.01));
+    CHECK(var == Approx(hand_var).epsilon(0.05));
+  }
+}
+
+TEMPLATE_TEST_CASE("Inverse cdf sampler", "[beta][normal][sampler]", REAL_TYPES) {
+
+  const TestType u_resolution =
+      std::max(TestType{1e-10L}, TestType{512.0} * std::numeric_limits<TestType>::epsilon());
+
+  // The u-error as the sampler measures it, from the nearer tail. Next to a pole no x can do
+  // better than the mass of the few ulps either side of it, and subnormal x, with too few bits
+  // for the bound, are not checked.
+  const auto check_u_errors = [&](const auto &dist,
+                                  const zoo::InverseCdfSampler<TestType> &sampler) {
+    constexpr TestType inf = std::numeric_limits<TestType>::infinity();
+    TestType previous = -inf;
+    for (int i = 1; i < 10000; ++i) {
+      const TestType u = TestType(i) / TestType{10000.0};
+      const TestType x = sampler.inverse(u);
+      if (std::fabs(x) < std::numeric_limits<TestType>::min()) {
+        continue;
+      }
+      const TestType below = std::nextafter(std::nextafter(x, -inf), -inf);
+      const TestType above = std::nextafter(std::nextafter(x, inf), inf);
+      const TestType error =
+          u > TestType{0.5} ? (TestType{1.0} - u) - dist.survival(x) : dist.cdf(x) - u;
+      const TestType ulp_mass = u > TestType{0.5} ? dist.survival(below) - dist.survival(above)
+                                                  : dist.cdf(above) - dist.cdf(below);
+      CHECK(std::fabs(error) <= TestType{1.5} * u_resolution + ulp_mass);
+      CHECK(x >= previous);
+      previous = x;
+    }
+  };
+
+  SECTION("u-error") {
+    // Including strong poles of the density at either end
+    for (const auto &[alpha, beta] :
+         {std::pair{2.6, 4.9}, std::pair{0.4, 0.7}, std::pair{1.0, 1.0}, std::pair{40.0, 3.5},
+          std::pair{0.05, 5.0}, std::pair{0.01, 5.0}, std::pair{5.0, 0.05}}) {
+      const zoo::StaticBeta<TestType> dist{TestType(alpha), TestType(beta)};
+      const zoo::InverseCdfSampler<TestType> sampler{dist, u_resolution};
+      CHECK(sampler.u_resolution() == u_resolution);
+      CHECK(sampler.size() > 0u);
+      check_u_errors(dist, sampler);
+    }
+
+    const zoo::StaticNormal<TestType> normal{TestType{-1.7L}, TestType{0.8L}};
+    check_u_errors(normal, zoo::InverseCdfSampler<TestType>{normal, u_resolution});
+  }
+
+  SECTION("Sampling") {
+    const zoo::StaticBeta<TestType> dist{TestType{2.6L}, TestType{4.9L}};
+    const zoo::InverseCdfSampler<TestType> sampler{dist, u_resolution};
+
+    // fill and single draws invert the same uniforms
+    zoo::Philox4x32 engine{7u};
+    zoo::Philox4x32 copy = engine;
+    std::vector<TestType> filled(1001);
+    sampler.fill(engine, filled.data(), filled.size());
+    for (const TestType x : filled) {
+      CHECK(x == sampler(copy));
+    }
+
+    zoo::Beta<TestType, zoo::Philox4x32> beta{TestType{2.6L}, TestType{4.9L}, zoo::Philox4x32{3u}};
+    CHECK(!beta.uses_inverse_cdf());
+    beta.use_inverse_cdf(u_resolution);
+    CHECK(beta.uses_inverse_cdf());
+
+    const auto sample = beta.randn(40000);
+    CHECK(std::all_of(sample.begin(), sample.end(),
+                      [](const TestType x) { return x > TestType{0.0} && x < TestType{1.0}; }));
+    const auto [mean, var] = zoo::moments(sample);
+    const TestType hand_mean = TestType{2.6L} / TestType{7.5L};
+    const TestType hand_var = TestType{2.6L} * TestType{4.9L} / (TestType{7.5L * 7.5L * 8.5L});
+    CHECK(mean == Approx(hand_mean).margin(0.01));
+    CHECK(var == Approx(hand_var).epsilon(0.05));
+
+    // Draws come from an equivalent table
+    zoo::Philox4x32 beta_engine{11u};
+    zoo::Philox4x32 table_engine{11u};
+    TestType x;
+    beta.fill(beta_engine, &x, 1);
+    CHECK(x == sampler(table_engine));
+
+    beta.use_rejection();
+    CHECK(!beta.uses_inverse_cdf());
+  }
+}
+
+TEMPLATE_TEST_CASE("Approximate pdf", "[beta][normal][approximation]", REAL_TYPES) {
+
+  const TestType tolerance =
+      std::max(TestType{1e-10L}, TestType{4096.0} * std::numeric_limits<TestType>::epsilon());
+
+  const auto check_errors = [&](const auto &dist, const TestType lo, const TestType hi) {
+    const zoo::ApproximatePdf<std::decay_t<decltype(dist)>> approx{dist, lo, hi, tolerance};
+
+    TestType peak{0.0};
+    std::vector<TestType> xs;
+    for (int i = 0; i <= 5000; ++i) {
+      xs.push_back(lo + (hi - lo) * TestType(i) / TestType{5000.0});
+      peak = std::max(peak, dist.pdf(xs.back()));
+    }
+    for (const TestType x : xs) {
+      CHECK(approx.pdf(x) == Approx(dist.pdf(x)).margin(2 * tolerance * peak));
+      CHECK(approx.log_pdf(x) == Approx(dist.log_pdf(x)).margin(2 * tolerance));
+    }
+    CHECK(approx.pdf_error() <= tolerance * peak * 2);
+    CHECK(approx.log_pdf_error() <= tolerance);
+
+    // The batch forms loop over the scalar ones
+    std::vector<TestType> out(xs.size());
+    approx.log_pdf(xs.data(), out.data(), xs.size());
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      CHECK(out[i] == approx.log_pdf(xs[i]));
+    }
+
+    // Outside the domain, and for everything but the densities, the distribution answers
+    for (const TestType x : {lo - (hi - lo) / 8, hi + (hi - lo) / 8}) {
+      CHECK(approx.pdf(x) == dist.pdf(x));
+      CHECK(approx.log_pdf(x) == dist.log_pdf(x));
+    }
+    const TestType nan = std::numeric_limits<TestType>::quiet_NaN();
+    CHECK(std::isnan(approx.pdf(nan)) == std::isnan(dist.pdf(nan)));
+    CHECK(approx.cdf(xs[100]) == dist.cdf(xs[100]));
+    CHECK(approx.quantile(TestType{0.3L}) == dist.quantile(TestType{0.3L}));
+
+    zoo::Philox4x32 engine{5u};
+    zoo::Philox4x32 copy = engine;
+    CHECK(approx.rand(engine) == dist.rand(copy));
+
+    CHECK(zoo::log_likelihood(approx, xs) ==
+          Approx(zoo::log_likelihood(dist, xs)).margin(2 * tolerance * TestType(xs.size())));
+  };
+
+  check_errors(zoo::StaticBeta<TestType>{TestType{2.6L}, TestType{4.9L}}, TestType{0.01L},
+               TestType{0.99L});
+  check_errors(zoo::StaticBeta<TestType>{TestType{0.4L}, TestType{0.7L}}, TestType{0.05L},
+               TestType{0.95L});
+  check_errors(zoo::StaticNormal<TestType>{TestType{-1.7L}, TestType{0.8L}}, TestType{-6.0},
+               TestType{3.0});
+
+  // A singular log density at the ends of the support cannot be fitted there, but the error
+  // says so and the fit holds away from them
+  const zoo::StaticBeta<TestType> dist{TestType{2.6L}, TestType{4.9L}};
+  const zoo::ApproximatePdf<zoo::StaticBeta<TestType>> full{dist, TestType{0.0}, TestType{1.0},
+                                                            tolerance};
+  CHECK(full.log_pdf_error() > tolerance);
+  CHECK(full.log_pdf(TestType{0.3L}) == Approx(dist.log_pdf(TestType{0.3L})).margin(tolerance));
+  CHECK(full.pdf(TestType{0.0}) >= TestType{0.0});
+  CHECK(full.pdf(TestType{0.0}) == Approx(TestType{0.0}).margin(4 * tolerance));
 }
@@ -0,0 +1,126 @@
+/*
+MIT License
+
+Copyright (c) 2019 University of Oxford
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "catch.hpp"
+
+#include <limits>
+#include <vector>
+
+#include "continuous_univariate.hpp"
+#include "zoo_random.hpp"
+
+#define REAL_TYPES float, double, long double
+
+TEST_CASE("Philox4x32 known answers", "[philox]") {
+
+  // Known-answer vectors from the Random123 distribution
+  using C = zoo::Philox4x32::counter_type;
+  using K = zoo::Philox4x32::key_type;
+
+  CHECK(zoo::Philox4x32::generate(C{0u, 0u, 0u, 0u}, K{0u, 0u}) ==
+        C{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u});
+
+  CHECK(zoo::Philox4x32::generate(C{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+                                  K{0xffffffffu, 0xffffffffu}) ==
+        C{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu});
+
+  CHECK(zoo::Philox4x32::generate(C{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+                                  K{0xa4093822u, 0x299f31d0u}) ==
+        C{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u});
+
+  // The engine walks the blocks of stream 0 in counter order
+  zoo::Philox4x32 engine{0u};
+  CHECK(engine() == 0x6627e8d5u);
+  CHECK(engine() == 0xe169c58du);
+  CHECK(engine() == 0xbc57ac4cu);
+  CHECK(engine() == 0x9b00dbd8u);
+}
+
+TEST_CASE("Philox4x32 random access", "[philox]") {
+
+  zoo::Philox4x32 sequential{1234u, 5u};
+  std::vector<zoo::Philox4x32::result_type> outputs(1001);
+  for (auto &x : outputs) {
+    x = sequential();
+  }
+
+  // Discarding and seeking land on the same outputs as stepping through them
+  zoo::Philox4x32 jumper{1234u, 5u};
+  jumper.discard(999u);
+  CHECK(jumper() == outputs[999]);
+
+  jumper.set_position(3u);
+  CHECK(jumper() == outputs[3]);
+  CHECK(jumper() == outputs[4]);
+  CHECK(jumper.position() == 5u);
+
+  // Streams and keys are distinct sequences
+  zoo::Philox4x32 other_stream{1234u, 6u};
+  zoo::Philox4x32 other_key{1235u, 5u};
+  CHECK(other_stream() != outputs[0]);
+  CHECK(other_key() != outputs[0]);
+
+  jumper.set_stream(5u);
+  CHECK(jumper == zoo::Philox4x32{1234u, 5u});
+  CHECK(jumper != other_stream);
+}
+
+TEMPLATE_TEST_CASE("Philox4x32 addressable draws", "[philox]", REAL_TYPES) {
+
+  // Draw i comes from stream i: the samplers keep no state between draws, so whatever earlier
+  // draws consumed does not matter
+  zoo::Beta<TestType, zoo::Philox4x32> dist{TestType{0.7}, TestType{2.5}, zoo::Philox4x32{99u}};
+
+  std::vector<TestType> draws(50);
+  for (std::size_t i = 0; i < draws.size(); ++i) {
+    dist.engine().set_stream(i);
+    draws[i] = dist.rand();
+  }
+
+  zoo::Beta<TestType, zoo::Philox4x32> jumper{TestType{0.7}, TestType{2.5}, zoo::Philox4x32{99u}};
+  for (const std::size_t i : {37u, 3u, 49u}) {
+    jumper.engine().set_stream(i);
+    CHECK(jumper.rand() == draws[i]);
+  }
+}
+
+TEST_CASE("Seed source", "[seed]") {
+
+  // Seeds are distinct, and reseeding replays them
+  zoo::SeedSource source{3u};
+  const auto s1 = source();
+  const auto s2 = source();
+  CHECK(s1 != s2);
+
+  source.seed(3u);
+  CHECK(source() == s1);
+  CHECK(source() == s2);
+
+  // The global source hands out distinct seeds too
+  CHECK(zoo::SeedSource::global()() != zoo::SeedSource::global()());
+
+  // Seeded engines are reproducible
+  CHECK(zoo::make_seeded_engine<std::mt19937>(s1) == zoo::make_seeded_engine<std::mt19937>(s1));
+  CHECK(zoo::make_seeded_engine<zoo::Philox4x32>(s1) == zoo::Philox4x32{s1});
+}
@@ -24,8 +24,12 @@ SOFTWARE.
 
 #include "catch.hpp"
 
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include "zoo_util.hpp"
 
@@ -68,3 +72,256 @@ TEMPLATE_TEST_CASE("Utility tests", "[util]", REAL_TYPES) {
   const auto median2 = zoo::median(v2);
   CHECK(median2 == Approx(hand_median).epsilon(e));
 }
+
+TEMPLATE_TEST_CASE("Moments accumulator", "[util]", REAL_TYPES) {
+
+  const TestType e = std::numeric_limits<TestType>::epsilon() * 1000;
+
+  // Large offset data, where E[x^2] - mean^2 would cancel catastrophically. The variance is still
+  // only good to about epsilon times the offset.
+  const TestType offset = std::is_same_v<TestType, float> ? TestType{1e4} : TestType{1e9};
+  const TestType e_var = std::numeric_limits<TestType>::epsilon() * offset;
+  std::vector<TestType> sample(7 * 429);
+  for (std::size_t i = 0; i < sample.size(); ++i) {
+    sample[i] = offset + TestType(static_cast<double>(i % 7) - 3.0);
+  }
+
+  const auto [mean, var] = zoo::moments(sample);
+  CHECK(mean == Approx(offset).epsilon(e));
+  CHECK(var == Approx(TestType{4.0}).epsilon(e_var));
+
+  // An empty sample has no moments
+  const auto [empty_mean, empty_var] = zoo::moments(std::vector<TestType>{});
+  CHECK(std::isnan(empty_mean));
+  CHECK(std::isnan(empty_var));
+
+  // Feeding one value at a time agrees with feeding blocks
+  zoo::MomentsAccumulator<TestType> single;
+  for (const auto x : sample) {
+    single.add(x);
+  }
+  CHECK(single.count() == sample.size());
+  CHECK(single.mean() == Approx(mean).epsilon(e));
+  CHECK(single.variance() == Approx(var).epsilon(e_var));
+  CHECK(single.sample_variance() == Approx(TestType{4.0 * 3003.0 / 3002.0}).epsilon(e_var));
+
+  // Merging accumulators fed with the parts of a sample agrees with the whole
+  zoo::MomentsAccumulator<TestType> first;
+  zoo::MomentsAccumulator<TestType> second;
+  zoo::MomentsAccumulator<TestType> empty;
+  first.add(sample.data(), 1000);
+  second.add(sample.data() + 1000, sample.size() - 1000);
+  first.merge(empty);
+  first.merge(second);
+  empty.merge(first);
+  CHECK(first.count() == sample.size());
+  CHECK(first.mean() == Approx(mean).epsilon(e));
+  CHECK(first.variance() == Approx(var).epsilon(e_var));
+  CHECK(empty.variance() == Approx(var).epsilon(e_var));
+}
+
+TEMPLATE_TEST_CASE("Higher moments accumulator", "[util]", REAL_TYPES) {
+
+  const TestType e = std::numeric_limits<TestType>::epsilon() * 1000;
+
+  // A skewed, offset sample long enough to span several blocks
+  std::vector<TestType> sample(2500);
+  for (std::size_t i = 0; i < sample.size(); ++i) {
+    const auto k = static_cast<double>(i % 10);
+    sample[i] = TestType(100.0 + k * k * 0.1);
+  }
+
+  // Two-pass reference in long double
+  long double mean = 0.0L;
+  for (const auto x : sample) {
+    mean += x;
+  }
+  mean /= sample.size();
+  long double m2 = 0.0L;
+  long double m3 = 0.0L;
+  long double m4 = 0.0L;
+  for (const auto x : sample) {
+    const long double d = x - mean;
+    m2 += d * d;
+    m3 += d * d * d;
+    m4 += d * d * d * d;
+  }
+  const long double n = sample.size();
+  const auto hand_var = static_cast<TestType>(m2 / n);
+  const auto hand_skew = static_cast<TestType>(std::sqrt(n) * m3 / std::pow(m2, 1.5L));
+  const auto hand_kurt = static_cast<TestType>(n * m4 / (m2 * m2) - 3.0L);
+
+  const auto [mean1, var1, skew1, kurt1] = zoo::higher_moments(sample);
+  CHECK(mean1 == Approx(static_cast<TestType>(mean)).epsilon(e));
+  CHECK(var1 == Approx(hand_var).epsilon(e));
+  CHECK(skew1 == Approx(hand_skew).epsilon(e));
+  CHECK(kurt1 == Approx(hand_kurt).epsilon(e));
+
+  // Single values, and merged partial accumulators, agree with the block form
+  zoo::HigherMomentsAccumulator<TestType> single;
+  for (const auto x : sample) {
+    single.add(x);
+  }
+  zoo::HigherMomentsAccumulator<TestType> first;
+  zoo::HigherMomentsAccumulator<TestType> second;
+  first.add(sample.data(), 777);
+  second.add(sample.data() + 777, sample.size() - 777);
+  first.merge(second);
+
+  for (const auto &acc : {single, first}) {
+    CHECK(acc.count() == sample.size());
+    CHECK(acc.mean() == Approx(mean1).epsilon(e));
+    CHECK(acc.variance() == Approx(var1).epsilon(e));
+    CHECK(acc.skewness() == Approx(skew1).epsilon(e));
+    CHECK(acc.excess_kurtosis() == Approx(kurt1).epsilon(e));
+  }
+
+  // A symmetric sample has no skew, and a constant one has no shape at all
+  const std::vector<TestType> symmetric = {TestType{-3.0}, TestType{-1.0}, TestType{0.0},
+                                           TestType{1.0}, TestType{3.0}};
+  const auto [mean2, var2, skew2, kurt2] = zoo::higher_moments(symmetric);
+  CHECK(mean2 == Approx(TestType{0.0}).margin(e));
+  CHECK(var2 == Approx(TestType{4.0}).epsilon(e));
+  CHECK(skew2 == Approx(TestType{0.0}).margin(e));
+  CHECK(kurt2 == Approx(TestType{164.0} / TestType{80.0} - TestType{3.0}).epsilon(e));
+
+  const auto [mean3, var3, skew3, kurt3] = zoo::higher_moments(std::vector<TestType>(5, 2));
+  CHECK(var3 == TestType{0.0});
+  CHECK(skew3 == TestType{0.0});
+  CHECK(kurt3 == TestType{0.0});
+}
+
+TEMPLATE_TEST_CASE("Multi-quantile selection", "[util]", REAL_TYPES) {
+
+  // A shuffled permutation of 0, 1, ..., 100, so the k-th order statistic is k
+  std::vector<TestType> sample(101);
+  for (std::size_t i = 0; i < sample.size(); ++i) {
+    sample[i] = TestType(static_cast<double>((i * 37) % 101));
+  }
+  const std::vector<TestType> original = sample;
+
+  const std::vector<TestType> probs = {TestType{0.9}, TestType{0.0}, TestType{0.5},
+                                       TestType{0.25}, TestType{1.0}, TestType{0.5}};
+  const auto qs = zoo::quantiles(sample, probs);
+  REQUIRE(qs.size() == probs.size());
+  for (std::size_t j = 0; j < probs.size(); ++j) {
+    CHECK(qs[j] == TestType(static_cast<double>(zoo::quantile_rank(probs[j], sample.size()))));
+  }
+  CHECK(qs[1] == TestType{0.0});
+  CHECK(qs[4] == TestType{100.0});
+
+  // The sample is untouched, and the median quantile matches median
+  CHECK(sample == original);
+  CHECK(qs[2] == zoo::median(sample));
+
+  // A workspace is reused across calls of different sizes
+  zoo::QuantileWorkspace<TestType> workspace;
+  const std::vector<TestType> small = {TestType{3.0}, TestType{1.0}, TestType{2.0}};
+  CHECK(zoo::quantiles(original, probs, workspace) == qs);
+  CHECK(zoo::quantiles(small, {TestType{0.0}, TestType{0.5}, TestType{1.0}}, workspace) ==
+        std::vector<TestType>{TestType{1.0}, TestType{2.0}, TestType{3.0}});
+
+  // An empty sample has no quantiles, but asking for none of them is fine
+  const std::vector<TestType> empty;
+  CHECK_THROWS_AS(zoo::quantiles(empty, probs, workspace), std::out_of_range);
+  CHECK(zoo::quantiles(empty, std::vector<TestType>{}, workspace).empty());
+}
+
+TEMPLATE_TEST_CASE("Quantile sketch", "[util]", REAL_TYPES) {
+
+  // Short streams are answered exactly
+  zoo::QuantileSketch<TestType> small;
+  const std::vector<TestType> values = {TestType{5.0}, TestType{1.0}, TestType{4.0},
+                                        TestType{2.0}, TestType{3.0}};
+  small.add(values.data(), values.size());
+  CHECK(small.quantile(TestType{0.5}) == TestType{3.0});
+  CHECK(small.quantile(TestType{0.0}) == TestType{1.0});
+  CHECK(small.quantile(TestType{1.0}) == TestType{5.0});
+  CHECK(small.cdf(TestType{2.0}) == Approx(TestType{0.4}));
+
+  // A long stream, a shuffled permutation of 0, 1, ..., n - 1, so the p-quantile should be near pn
+  const std::size_t n = 100003;
+  zoo::QuantileSketch<TestType> whole;
+  zoo::QuantileSketch<TestType> first{200, 1};
+  zoo::QuantileSketch<TestType> second{200, 2};
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto x = TestType(static_cast<double>((i * 7919) % n));
+    whole.add(x);
+    (i % 3 == 0 ? first : second).add(x);
+  }
+  first.merge(second);
+
+  // Sketches of different sizes do not merge
+  zoo::QuantileSketch<TestType> coarse{50, 3};
+  CHECK(coarse.k() == 50u);
+  CHECK_THROWS_AS(first.merge(coarse), std::invalid_argument);
+  CHECK_THROWS_AS(coarse.merge(first), std::invalid_argument);
+
+  CHECK(whole.count() == n);
+  CHECK(first.count() == n);
+  CHECK(whole.size() < 1000u);
+  CHECK(first.size() < 1000u);
+
+  const std::vector<TestType> probs = {TestType{0.01}, TestType{0.25}, TestType{0.5},
+                                       TestType{0.75}, TestType{0.99}};
+  const double tolerance = 0.02 * n;
+  for (const auto &sketch : {whole, first}) {
+    const auto qs = sketch.quantiles(probs);
+    for (std::size_t j = 0; j < probs.size(); ++j) {
+      CHECK(qs[j] == sketch.quantile(probs[j]));
+      const double expected = static_cast<double>(probs[j]) * n;
+      CHECK(static_cast<double>(qs[j]) == Approx(expected).margin(tolerance));
+    }
+    CHECK(static_cast<double>(sketch.cdf(TestType(n / 2.0))) == Approx(0.5).margin(0.02));
+  }
+}
+
+TEMPLATE_TEST_CASE("Parallel selection", "[util]", REAL_TYPES) {
+
+  // Large enough to take the parallel path, with many repeated values
+  const std::size_t n = 200001;
+  std::vector<TestType> sample(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    sample[i] = TestType(static_cast<double>((i * 7919) % 100003));
+  }
+  const std::vector<TestType> original = sample;
+
+  std::vector<TestType> sorted = sample;
+  std::sort(sorted.begin(), sorted.end());
+
+  for (const std::size_t k : {std::size_t{0}, std::size_t{1234}, n / 2, n - 1}) {
+    for (const unsigned n_threads : {1u, 2u, 5u}) {
+      CHECK(zoo::parallel_select(sample.data(), n, k, n_threads) == sorted[k]);
+    }
+  }
+
+  // Matches median, which reorders its argument, while leaving the sample alone
+  const TestType median = zoo::parallel_median(sample, 4);
+  CHECK(sample == original);
+  CHECK(median == zoo::median(sample));
+
+  // Constant data collapses the bracket to a single value
+  const std::vector<TestType> constant(n, TestType{2.5});
+  CHECK(zoo::parallel_median(constant, 3) == TestType{2.5});
+
+  // Sizes either side of the threshold for the parallel path
+  for (const std::size_t m : {std::size_t{1}, std::size_t{1000}, std::size_t{65535},
+                              std::size_t{65536}, std::size_t{65537}, std::size_t{131071}}) {
+    const auto end = sample.begin() + static_cast<std::ptrdiff_t>(m);
+    const std::vector<TestType> small(sample.begin(), end);
+    std::vector<TestType> small_sorted = small;
+    std::sort(small_sorted.begin(), small_sorted.end());
+    for (const std::size_t k : {std::size_t{0}, m / 2, m - 1}) {
+      for (const unsigned n_threads : {0u, 1u, 2u, 8u}) {
+        CHECK(zoo::parallel_select(small.data(), m, k, n_threads) == small_sorted[k]);
+      }
+    }
+    std::vector<TestType> copy = small;
+    CHECK(zoo::parallel_median(small, 4) == zoo::median(copy));
+  }
+
+  // An empty sample has no median
+  std::vector<TestType> empty;
+  CHECK_THROWS_AS(zoo::parallel_median(empty, 4), std::out_of_range);
+  CHECK_THROWS_AS(zoo::median(empty), std::out_of_range);
+}
@@ -0,0 +1,238 @@
+/*
+MIT License
+
+Copyright (c) 2019 University of Oxford
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ZOO_RANDOM_HPP_
+#define ZOO_RANDOM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+namespace zoo {
+
+// Counter-based Philox4x32-10 engine (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+// 3", SC11). Output is a pure function of (key, stream, position), so any position in any
+// stream can be reached in O(1) and results do not depend on how work is split between threads.
+// The 128-bit counter holds the 64-bit block position in words 0-1 and the stream id in 2-3.
+class Philox4x32 {
+public:
+  using result_type = std::uint32_t;
+  using counter_type = std::array<std::uint32_t, 4>;
+  using key_type = std::array<std::uint32_t, 2>;
+
+  static constexpr std::uint64_t default_seed = 20111115u;
+
+  static constexpr result_type min() { return 0u; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  Philox4x32() : Philox4x32(default_seed) {}
+
+  explicit Philox4x32(const std::uint64_t key, const std::uint64_t stream = 0u) {
+    seed(key, stream);
+  }
+
+  void seed(const std::uint64_t key = default_seed, const std::uint64_t stream = 0u) {
+    mKey = {static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32u)};
+    set_stream(stream);
+  }
+
+  // Jump to the start of another stream under the same key.
+  void set_stream(const std::uint64_t stream) {
+    mStream = stream;
+    set_position(0u);
+  }
+
+  // Jump to the n-th 32-bit output of the current stream.
+  void set_position(const std::uint64_t n) {
+    mPosition = n;
+    mBufferValid = false;
+  }
+
+  std::uint64_t stream() const { return mStream; }
+  std::uint64_t position() const { return mPosition; }
+
+  void discard(const unsigned long long z) { set_position(mPosition + z); }
+
+  result_type operator()() {
+    const std::uint64_t block = mPosition / 4u;
+    if (!mBufferValid || block != mBufferBlock) {
+      const counter_type counter = {
+          static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32u),
+          static_cast<std::uint32_t>(mStream), static_cast<std::uint32_t>(mStream >> 32u)};
+      mBuffer = generate(counter, mKey);
+      mBufferBlock = block;
+      mBufferValid = true;
+    }
+    return mBuffer[mPosition++ % 4u];
+  }
+
+  // The Philox4x32-10 bijection: ten rounds applied to counter under key.
+  static counter_type generate(counter_type counter, key_type key) {
+    for (int round = 0; round < 10; ++round) {
+      if (round > 0) {
+        key[0] += 0x9E3779B9u;
+        key[1] += 0xBB67AE85u;
+      }
+      const std::uint64_t p0 = std::uint64_t{0xD2511F53u} * counter[0];
+      const std::uint64_t p1 = std::uint64_t{0xCD9E8D57u} * counter[2];
+      counter = {static_cast<std::uint32_t>(p1 >> 32u) ^ counter[1] ^ key[0],
+                 static_cast<std::uint32_t>(p1),
+                 static_cast<std::uint32_t>(p0 >> 32u) ^ counter[3] ^ key[1],
+                 static_cast<std::uint32_t>(p0)};
+    }
+    return counter;
+  }
+
+  friend bool operator==(const Philox4x32 &a, const Philox4x32 &b) {
+    return a.mKey == b.mKey && a.mStream == b.mStream && a.mPosition == b.mPosition;
+  }
+
+  friend bool operator!=(const Philox4x32 &a, const Philox4x32 &b) { return !(a == b); }
+
+private:
+  key_type mKey{};
+  std::uint64_t mStream = 0u;
+  std::uint64_t mPosition = 0u;
+
+  // The most recently generated block, cached so consecutive calls cost one round function per
+  // four outputs.
+  counter_type mBuffer{};
+  std::uint64_t mBufferBlock = 0u;
+  bool mBufferValid = false;
+};
+
+// 32 and 64 uniformly random bits from any engine, using one call per 32 or 64 bits when the
+// engine's range allows it.
+template <class Engine> std::uint32_t random_bits32(Engine &engine) {
+  constexpr auto range = Engine::max() - Engine::min();
+  if constexpr (range >= std::numeric_limits<std::uint32_t>::max()) {
+    return static_cast<std::uint32_t>(engine() - Engine::min());
+  } else {
+    return std::uniform_int_distribution<std::uint32_t>{}(engine);
+  }
+}
+
+template <class Engine> std::uint64_t random_bits64(Engine &engine) {
+  constexpr auto range = Engine::max() - Engine::min();
+  if constexpr (range == std::numeric_limits<std::uint64_t>::max()) {
+    return static_cast<std::uint64_t>(engine() - Engine::min());
+  } else if constexpr (range == std::numeric_limits<std::uint32_t>::max()) {
+    const std::uint64_t hi = engine() - Engine::min();
+    return (hi << 32u) | static_cast<std::uint64_t>(engine() - Engine::min());
+  } else {
+    return std::uniform_int_distribution<std::uint64_t>{}(engine);
+  }
+}
+
+// Number of random bits behind uniform_open<real>: one fewer than the significand, so that the
+// midpoint offset below is exact, and at most 63.
+template <class real>
+constexpr int uniform_bits = std::min(std::numeric_limits<real>::digits - 1, 63);
+
+// Maps the top uniform_bits<real> bits of `bits` to the open interval (0, 1).
+template <class real> real uniform_open_from_bits(const std::uint64_t bits) {
+  constexpr int b = uniform_bits<real>;
+  constexpr real scale = real{1.0} / static_cast<real>(std::uint64_t{1} << b);
+  return (static_cast<real>(bits >> (64 - b)) + real{0.5}) * scale;
+}
+
+// A uniform draw on (0, 1), never returning either endpoint.
+template <class real, class Engine> real uniform_open(Engine &engine) {
+  if constexpr (uniform_bits<real> <= 32) {
+    return uniform_open_from_bits<real>(std::uint64_t{random_bits32(engine)} << 32u);
+  } else {
+    return uniform_open_from_bits<real>(random_bits64(engine));
+  }
+}
+
+// The SplitMix64 output function (Steele et al. 2014), a cheap bijective mixer of 64-bit values.
+inline std::uint64_t splitmix64(std::uint64_t z) {
+  z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9u;
+  z = (z ^ (z >> 27u)) * 0x94D049BB133111EBu;
+  return z ^ (z >> 31u);
+}
+
+// A thread-safe source of well-mixed, distinct 64-bit seeds: a SplitMix64 sequence over an atomic
+// counter. global() is seeded once per process from std::random_device, so creating a
+// distribution costs an atomic increment rather than a read of the system entropy source.
+class SeedSource {
+private:
+  static constexpr std::uint64_t golden_gamma = 0x9E3779B97F4A7C15u;
+  std::atomic<std::uint64_t> mState;
+
+public:
+  explicit SeedSource(const std::uint64_t seed) : mState(seed) {}
+
+  std::uint64_t operator()() {
+    return splitmix64(mState.fetch_add(golden_gamma, std::memory_order_relaxed) + golden_gamma);
+  }
+
+  // Restart the sequence, e.g. to make a whole run reproducible.
+  void seed(const std::uint64_t seed) { mState.store(seed, std::memory_order_relaxed); }
+
+  static SeedSource &global() {
+    static SeedSource source{[] {
+      std::random_device rd;
+      return std::uint64_t{rd()} << 32u ^ std::uint64_t{rd()};
+    }()};
+    return source;
+  }
+};
+
+// An engine seeded from a single 64-bit value. Engines with 32-bit seeds use its low half.
+template <class Engine> Engine make_seeded_engine(const std::uint64_t seed) {
+  if constexpr (std::is_same_v<Engine, Philox4x32>) {
+    return Philox4x32{seed};
+  } else {
+    return Engine(static_cast<typename Engine::result_type>(seed));
+  }
+}
+
+// A fresh engine seeded from SeedSource::global().
+template <class Engine> Engine make_seeded_engine() {
+  return make_seeded_engine<Engine>(SeedSource::global()());
+}
+
+// An engine for substream `stream` of the family identified by `seed`. Generic engines are seeded
+// from a std::seed_seq over both values; counter-based engines map the pair directly onto their
+// key and stream, which guarantees the substreams do not overlap.
+template <class Engine>
+Engine make_stream_engine(const std::uint64_t seed, const std::uint64_t stream) {
+  if constexpr (std::is_same_v<Engine, Philox4x32>) {
+    return Philox4x32{seed, stream};
+  } else {
+    std::seed_seq seq{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32u),
+                      static_cast<std::uint32_t>(stream),
+                      static_cast<std::uint32_t>(stream >> 32u)};
+    return Engine{seq};
+  }
+}
+
+} // namespace zoo
+
+#endif // ZOO_RANDOM_HPP_
@@ -25,19 +25,260 @@ SOFTWARE.
 #ifndef ZOO_UTIL_HPP_
 #define ZOO_UTIL_HPP_
 
-#include <numeric>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace zoo {
 
+// Independent partial sums used by the accumulators below, which the compiler can keep in vector
+// registers
+constexpr std::size_t moments_lanes = 8;
+
+// Sum of x[0..n) over moments_lanes partial sums
+template <class real> real lane_sum(const real *x, const std::size_t n) {
+  real acc[moments_lanes] = {};
+  std::size_t i = 0;
+  for (; i + moments_lanes <= n; i += moments_lanes) {
+    for (std::size_t j = 0; j < moments_lanes; ++j) {
+      acc[j] += x[i + j];
+    }
+  }
+  for (; i < n; ++i) {
+    acc[0] += x[i];
+  }
+  real sum{0.0};
+  for (std::size_t j = 0; j < moments_lanes; ++j) {
+    sum += acc[j];
+  }
+  return sum;
+}
+
+// Single-pass running mean and variance (Welford), which can be fed one value or one block at a
+// time and merged with accumulators fed elsewhere, e.g. on other threads (Chan, Golub & LeVeque).
+// It tracks deviations from the running mean, so large offsets do not cost precision.
+template <class real> class MomentsAccumulator {
+private:
+  std::uint64_t mCount{0};
+  real mMean{0.0};
+
+  // Sum of squared deviations from the mean
+  real mM2{0.0};
+
+  // Values per block in add(x, n). A block is small enough to stay in cache while it is read twice,
+  // for its own mean and then its deviations, so the data is streamed from memory only once.
+  static constexpr std::size_t block_size = 1024;
+
+  static constexpr std::size_t lanes = moments_lanes;
+
+  static real block_m2(const real *x, const std::size_t n, const real mean) {
+    real acc[lanes] = {};
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+      for (std::size_t j = 0; j < lanes; ++j) {
+        const real d = x[i + j] - mean;
+        acc[j] += d * d;
+      }
+    }
+    for (; i < n; ++i) {
+      acc[0] += (x[i] - mean) * (x[i] - mean);
+    }
+    real sum{0.0};
+    for (std::size_t j = 0; j < lanes; ++j) {
+      sum += acc[j];
+    }
+    return sum;
+  }
+
+  void merge(const std::uint64_t count, const real mean, const real m2) {
+    if (count == 0) {
+      return;
+    }
+    const std::uint64_t total = mCount + count;
+    const real delta = mean - mMean;
+    const real weight = static_cast<real>(count) / static_cast<real>(total);
+    mM2 += m2 + delta * delta * static_cast<real>(mCount) * weight;
+    mMean += delta * weight;
+    mCount = total;
+  }
+
+public:
+  void add(const real x) {
+    ++mCount;
+    const real delta = x - mMean;
+    mMean += delta / static_cast<real>(mCount);
+    mM2 += delta * (x - mMean);
+  }
+
+  // Add n values, a block at a time
+  void add(const real *x, const std::size_t n) {
+    for (std::size_t first = 0; first < n; first += block_size) {
+      const std::size_t m = std::min(block_size, n - first);
+      const real mean = lane_sum(x + first, m) / static_cast<real>(m);
+      merge(m, mean, block_m2(x + first, m, mean));
+    }
+  }
+
+  void merge(const MomentsAccumulator &other) { merge(other.mCount, other.mMean, other.mM2); }
+
+  std::uint64_t count() const { return mCount; }
+  real mean() const { return mMean; }
+
+  // Population variance, dividing by the count
+  real variance() const { return mCount > 0 ? mM2 / static_cast<real>(mCount) : real{0.0}; }
+
+  // Unbiased sample variance, dividing by the count less one
+  real sample_variance() const {
+    return mCount > 1 ? mM2 / static_cast<real>(mCount - 1) : real{0.0};
+  }
+};
+
+// Single-pass running mean and second to fourth central moments, fed and merged like
+// MomentsAccumulator, using the update and combination formulas of Pébay (2008), "Formulas for
+// robust, one-pass parallel computation of covariances and arbitrary-order statistical moments".
+template <class real> class HigherMomentsAccumulator {
+private:
+  std::uint64_t mCount{0};
+  real mMean{0.0};
+
+  // Sums of the second, third and fourth powers of deviations from the mean
+  real mM2{0.0};
+  real mM3{0.0};
+  real mM4{0.0};
+
+  static constexpr std::size_t block_size = 1024;
+  static constexpr std::size_t lanes = moments_lanes;
+
+  void merge(const std::uint64_t count, const real mean, const real m2, const real m3,
+             const real m4) {
+    if (count == 0) {
+      return;
+    }
+    const real na = static_cast<real>(mCount);
+    const real nb = static_cast<real>(count);
+    const real n = na + nb;
+    const real delta = mean - mMean;
+    const real delta_n = delta / n;
+    const real delta_n2 = delta_n * delta_n;
+    const real term = delta * delta_n * na * nb;
+
+    mM4 += m4 + term * delta_n2 * (na * na - na * nb + nb * nb) +
+           real{6.0} * delta_n2 * (na * na * m2 + nb * nb * mM2) +
+           real{4.0} * delta_n * (na * m3 - nb * mM3);
+    mM3 += m3 + term * delta_n * (na - nb) + real{3.0} * delta_n * (na * m2 - nb * mM2);
+    mM2 += m2 + term;
+    mMean += delta_n * nb;
+    mCount += count;
+  }
+
+public:
+  void add(const real x) {
+    const real n1 = static_cast<real>(mCount);
+    ++mCount;
+    const real n = static_cast<real>(mCount);
+    const real delta = x - mMean;
+    const real delta_n = delta / n;
+    const real delta_n2 = delta_n * delta_n;
+    const real term = delta * delta_n * n1;
+
+    mMean += delta_n;
+    mM4 += term * delta_n2 * (n * n - real{3.0} * n + real{3.0}) + real{6.0} * delta_n2 * mM2 -
+           real{4.0} * delta_n * mM3;
+    mM3 += term * delta_n * (n - real{2.0}) - real{3.0} * delta_n * mM2;
+    mM2 += term;
+  }
+
+  // Add n values, a block at a time: one pass for the block mean, one for the powers of the
+  // deviations from it, then a merge
+  void add(const real *x, const std::size_t n) {
+    for (std::size_t first = 0; first < n; first += block_size) {
+      const std::size_t m = std::min(block_size, n - first);
+      const real *block = x + first;
+      const real mean = lane_sum(block, m) / static_cast<real>(m);
+
+      real m2[lanes] = {};
+      real m3[lanes] = {};
+      real m4[lanes] = {};
+      std::size_t i = 0;
+      for (; i + lanes <= m; i += lanes) {
+        for (std::size_t j = 0; j < lanes; ++j) {
+          const real d = block[i + j] - mean;
+          const real d2 = d * d;
+          m2[j] += d2;
+          m3[j] += d2 * d;
+          m4[j] += d2 * d2;
+        }
+      }
+      for (; i < m; ++i) {
+        const real d = block[i] - mean;
+        m2[0] += d * d;
+        m3[0] += d * d * d;
+        m4[0] += d * d * d * d;
+      }
+
+      merge(m, mean, lane_sum(m2, lanes), lane_sum(m3, lanes), lane_sum(m4, lanes));
+    }
+  }
+
+  void merge(const HigherMomentsAccumulator &other) {
+    merge(other.mCount, other.mMean, other.mM2, other.mM3, other.mM4);
+  }
+
+  std::uint64_t count() const { return mCount; }
+  real mean() const { return mMean; }
+
+  // Population variance, dividing by the count
+  real variance() const { return mCount > 0 ? mM2 / static_cast<real>(mCount) : real{0.0}; }
+
+  // Population skewness, m3 / m2^(3/2), or zero if all values are equal
+  real skewness() const {
+    if (mM2 <= real{0.0}) {
+      return real{0.0};
+    }
+    return std::sqrt(static_cast<real>(mCount)) * mM3 / (mM2 * std::sqrt(mM2));
+  }
+
+  // Population excess kurtosis, m4 / m2^2 - 3, or zero if all values are equal
+  real excess_kurtosis() const {
+    if (mM2 <= real{0.0}) {
+      return real{0.0};
+    }
+    return static_cast<real>(mCount) * mM4 / (mM2 * mM2) - real{3.0};
+  }
+};
+
+// Mean and population variance of sample, in a single pass. Both are NaN for an empty sample, as
+// the ratios 0 / 0 they would be.
 template <class real> std::tuple<real, real> moments(const std::vector<real> &sample) {
 
-  const real mean = std::accumulate(sample.begin(), sample.end(), real{0.0}) / sample.size();
-  const real var =
-      std::inner_product(sample.begin(), sample.end(), sample.begin(), real{0.0}) / sample.size() -
-      mean * mean;
+  if (sample.empty()) {
+    const real nan = std::numeric_limits<real>::quiet_NaN();
+    return std::make_tuple(nan, nan);
+  }
 
-  return std::make_tuple(mean, var);
+  MomentsAccumulator<real> acc;
+  acc.add(sample.data(), sample.size());
+
+  return std::make_tuple(acc.mean(), acc.variance());
+}
+
+// Mean, population variance, skewness and excess kurtosis of sample, in a single pass
+template <class real>
+std::tuple<real, real, real, real> higher_moments(const std::vector<real> &sample) {
+
+  HigherMomentsAccumulator<real> acc;
+  acc.add(sample.data(), sample.size());
+
+  return std::make_tuple(acc.mean(), acc.variance(), acc.skewness(), acc.excess_kurtosis());
 }
 
 template <class real> real median(std::vector<real> &sample) {
@@ -47,6 +288,347 @@ template <class real> real median(std::vector<real> &sample) {
   return sample.at(half_way);
 }
 
+// Index of the p-quantile in a sorted sample of size n, min(n - 1, floor(p n)), so that the
+// 0.5-quantile is the same element as median
+template <class real> std::size_t quantile_rank(const real p, const std::size_t n) {
+  assert(p >= real{0.0} && p <= real{1.0});
+  assert(n > 0);
+  const auto rank = static_cast<std::size_t>(p * static_cast<real>(n));
+  return std::min(rank, n - 1);
+}
+
+// Reorders [first, last) so that, for each of the sorted ranks[0..n_ranks), the element at that
+// rank is the one a full sort would put there. The middle rank is selected first and each side is
+// recursed on with the ranks that fall in it, so m ranks cost one pass of O(n log m) rather than m
+// passes. Ranks are counted from offset, the rank of *first.
+template <class RandomIt>
+void multiselect(const RandomIt first, const RandomIt last, const std::size_t *ranks,
+                 const std::size_t n_ranks, const std::size_t offset = 0) {
+  if (n_ranks == 0 || first == last) {
+    return;
+  }
+  const std::size_t mid = n_ranks / 2;
+  const auto kth = first + static_cast<std::ptrdiff_t>(ranks[mid] - offset);
+  std::nth_element(first, kth, last);
+  multiselect(first, kth, ranks, mid, offset);
+  multiselect(kth + 1, last, ranks + mid + 1, n_ranks - mid - 1, ranks[mid] + 1);
+}
+
+// Scratch storage for quantiles, which keeps its capacity between calls so that repeated queries
+// do not allocate. The sample is copied into it, never reordered in place.
+template <class real> class QuantileWorkspace {
+private:
+  std::vector<real> mScratch;
+  std::vector<std::size_t> mRanks;
+
+public:
+  // out[j] = the probs[j]-quantile of x[0..n), for j < n_probs. Like median, throws
+  // std::out_of_range if any quantile of an empty sample is asked for.
+  void quantiles(const real *x, const std::size_t n, const real *probs, const std::size_t n_probs,
+                 real *out) {
+    if (n == 0 && n_probs > 0) {
+      throw std::out_of_range("quantiles of an empty sample");
+    }
+    mScratch.assign(x, x + n);
+
+    mRanks.resize(n_probs);
+    for (std::size_t j = 0; j < n_probs; ++j) {
+      mRanks[j] = quantile_rank(probs[j], n);
+    }
+    std::sort(mRanks.begin(), mRanks.end());
+    mRanks.erase(std::unique(mRanks.begin(), mRanks.end()), mRanks.end());
+
+    multiselect(mScratch.begin(), mScratch.end(), mRanks.data(), mRanks.size());
+
+    for (std::size_t j = 0; j < n_probs; ++j) {
+      out[j] = mScratch[quantile_rank(probs[j], n)];
+    }
+  }
+};
+
+// The probs-quantiles of sample, without modifying it, using workspace for scratch storage
+template <class real>
+std::vector<real> quantiles(const std::vector<real> &sample, const std::vector<real> &probs,
+                            QuantileWorkspace<real> &workspace) {
+  std::vector<real> out(probs.size());
+  workspace.quantiles(sample.data(), sample.size(), probs.data(), probs.size(), out.data());
+  return out;
+}
+
+template <class real>
+std::vector<real> quantiles(const std::vector<real> &sample, const std::vector<real> &probs) {
+  QuantileWorkspace<real> workspace;
+  return quantiles(sample, probs, workspace);
+}
+
+// The k-th smallest of x[0..n), the element a full sort would put at index k, found with up to
+// n_threads threads and without modifying x. Pivots bracketing rank k are taken from a sorted
+// random sample; one parallel pass counts the values below the bracket and gathers those inside
+// it, and only that small candidate set is searched with nth_element. If the bracket misses rank
+// k, which is very unlikely, the search falls back to a full nth_element on a copy. The result is
+// exact either way. x must not contain NaN.
+template <class real>
+real parallel_select(const real *x, const std::size_t n, const std::size_t k,
+                     const unsigned n_threads = std::thread::hardware_concurrency()) {
+  assert(k < n);
+
+  const auto select_copy = [x, n, k]() {
+    std::vector<real> copy(x, x + n);
+    std::nth_element(copy.begin(), copy.begin() + static_cast<std::ptrdiff_t>(k), copy.end());
+    return copy[k];
+  };
+
+  // Small problems are not worth the threads
+  constexpr std::size_t min_parallel_size = std::size_t{1} << 16u;
+  const std::size_t n_workers =
+      std::min(std::max<std::size_t>(n_threads, 1), n / min_parallel_size);
+  if (n_workers < 2) {
+    return select_copy();
+  }
+
+  // Pivots about three standard deviations either side of rank k in a sample of size s. The
+  // bracket then holds a fraction of about 6 / sqrt(s) of the values.
+  const std::size_t s = std::clamp(n / 64, std::size_t{1} << 12u, std::size_t{1} << 18u);
+  std::vector<real> sample(s);
+  std::mt19937_64 engine{n};
+  std::uniform_int_distribution<std::size_t> index{0, n - 1};
+  for (auto &value : sample) {
+    value = x[index(engine)];
+  }
+  std::sort(sample.begin(), sample.end());
+
+  const auto centre = static_cast<double>(k) / static_cast<double>(n) * static_cast<double>(s);
+  const double margin = 3.0 * std::sqrt(static_cast<double>(s));
+  const real low = sample[static_cast<std::size_t>(std::max(0.0, centre - margin))];
+  const real high = sample[std::min(s - 1, static_cast<std::size_t>(centre + margin))];
+
+  // One pass: count values below the bracket and gather those inside it, per thread
+  std::vector<std::size_t> below(n_workers, 0);
+  std::vector<std::vector<real>> inside(n_workers);
+  const auto worker = [&](const std::size_t t) {
+    const std::size_t first = n * t / n_workers;
+    const std::size_t last = n * (t + 1) / n_workers;
+    std::size_t count = 0;
+    for (std::size_t i = first; i < last; ++i) {
+      if (x[i] < low) {
+        ++count;
+      } else if (!(high < x[i])) {
+        inside[t].push_back(x[i]);
+      }
+    }
+    below[t] = count;
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < n_workers; ++t) {
+    threads.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::size_t n_below = 0;
+  std::size_t n_inside = 0;
+  for (std::size_t t = 0; t < n_workers; ++t) {
+    n_below += below[t];
+    n_inside += inside[t].size();
+  }
+  if (k < n_below || k >= n_below + n_inside) {
+    return select_copy();
+  }
+
+  std::vector<real> candidates;
+  candidates.reserve(n_inside);
+  for (const auto &part : inside) {
+    candidates.insert(candidates.end(), part.begin(), part.end());
+  }
+  const auto kth = candidates.begin() + static_cast<std::ptrdiff_t>(k - n_below);
+  std::nth_element(candidates.begin(), kth, candidates.end());
+  return *kth;
+}
+
+// The same element as median(sample), found in parallel without modifying sample. Like median,
+// throws std::out_of_range for an empty sample.
+template <class real>
+real parallel_median(const std::vector<real> &sample,
+                     const unsigned n_threads = std::thread::hardware_concurrency()) {
+  if (sample.empty()) {
+    throw std::out_of_range("parallel_median of an empty sample");
+  }
+  return parallel_select(sample.data(), sample.size(), sample.size() / 2, n_threads);
+}
+
+// Mergeable, bounded-memory quantile sketch for streams too large to keep, after Karnin, Lang &
+// Liberty (2016), "Optimal quantile approximation in streams" (KLL). Items are kept in levels,
+// where an item at level h stands for 2^h stream values. When the sketch is full, a level is
+// sorted and every other item, starting at a random offset, is promoted to the next level with
+// the rest discarded, which keeps the expected ranks unbiased.
+//
+// With level capacities shrinking by 2/3 from the top, the sketch keeps about 3k items. The rank
+// of a reported quantile is within roughly 2/k of the requested rank, as a fraction of the count,
+// with high probability: about 1% for the default k = 200. Streams of fewer than k values are
+// answered exactly.
+template <class real> class QuantileSketch {
+private:
+  std::size_t mK;
+  std::vector<std::vector<real>> mLevels;
+
+  // Values seen, items retained, and the retained items at which a compaction is due
+  std::uint64_t mCount{0};
+  std::size_t mSize{0};
+  std::size_t mMaxSize{0};
+
+  // SplitMix64 state for the compaction offsets
+  std::uint64_t mRandomState;
+
+  std::size_t capacity(const std::size_t h) const {
+    const auto height = static_cast<double>(mLevels.size() - h - 1);
+    return static_cast<std::size_t>(std::ceil(std::pow(2.0 / 3.0, height) * mK)) + 1;
+  }
+
+  void grow() {
+    mLevels.emplace_back();
+    mMaxSize = 0;
+    for (std::size_t h = 0; h < mLevels.size(); ++h) {
+      mMaxSize += capacity(h);
+    }
+  }
+
+  bool random_bit() {
+    std::uint64_t z = (mRandomState += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27u)) * 0x94D049BB133111EBu;
+    return ((z ^ (z >> 31u)) >> 63u) != 0;
+  }
+
+  // Promote every other item of level h, keeping the smallest item back if the count is odd
+  void compact(const std::size_t h) {
+    if (h + 1 == mLevels.size()) {
+      grow();
+    }
+    auto &level = mLevels[h];
+    auto &next = mLevels[h + 1];
+
+    std::sort(level.begin(), level.end());
+    const std::size_t odd = level.size() % 2;
+    for (std::size_t i = odd + (random_bit() ? 1 : 0); i < level.size(); i += 2) {
+      next.push_back(level[i]);
+    }
+    mSize -= level.size() - odd - (level.size() - odd) / 2;
+    level.resize(odd);
+  }
+
+  void compress() {
+    while (mSize >= mMaxSize) {
+      for (std::size_t h = 0; h < mLevels.size(); ++h) {
+        if (mLevels[h].size() >= capacity(h)) {
+          compact(h);
+          break;
+        }
+      }
+    }
+  }
+
+  // Retained items with their weights, sorted by value
+  std::vector<std::pair<real, std::uint64_t>> weighted_items() const {
+    std::vector<std::pair<real, std::uint64_t>> items;
+    items.reserve(mSize);
+    for (std::size_t h = 0; h < mLevels.size(); ++h) {
+      for (const real x : mLevels[h]) {
+        items.emplace_back(x, std::uint64_t{1} << h);
+      }
+    }
+    std::sort(items.begin(), items.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    return items;
+  }
+
+  static real quantile_of(const std::vector<std::pair<real, std::uint64_t>> &items,
+                          const std::uint64_t count, const real p) {
+    const auto rank = static_cast<std::uint64_t>(quantile_rank(p, count));
+    std::uint64_t cumulative = 0;
+    for (const auto &[x, weight] : items) {
+      cumulative += weight;
+      if (cumulative > rank) {
+        return x;
+      }
+    }
+    return items.back().first;
+  }
+
+public:
+  explicit QuantileSketch(const std::size_t k = 200, const std::uint64_t seed = 0)
+      : mK(k), mRandomState(seed) {
+    assert(k >= 2);
+    grow();
+  }
+
+  void add(const real x) {
+    mLevels[0].push_back(x);
+    ++mCount;
+    ++mSize;
+    compress();
+  }
+
+  void add(const real *x, const std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      add(x[i]);
+    }
+  }
+
+  // Fold in a sketch of another stream, e.g. from another thread. The error bound is that of a
+  // single sketch of both streams. Both sketches must have the same k, since the merged levels
+  // take this sketch's capacities; otherwise throws std::invalid_argument.
+  void merge(const QuantileSketch &other) {
+    if (other.mK != mK) {
+      throw std::invalid_argument("QuantileSketch::merge needs sketches with the same k");
+    }
+    while (mLevels.size() < other.mLevels.size()) {
+      grow();
+    }
+    for (std::size_t h = 0; h < other.mLevels.size(); ++h) {
+      mLevels[h].insert(mLevels[h].end(), other.mLevels[h].begin(), other.mLevels[h].end());
+    }
+    mCount += other.mCount;
+    mSize += other.mSize;
+    compress();
+  }
+
+  std::size_t k() const { return mK; }
+
+  // Values seen, and items retained
+  std::uint64_t count() const { return mCount; }
+  std::size_t size() const { return mSize; }
+
+  // Approximate p-quantile, using the rank convention of quantile_rank
+  real quantile(const real p) const {
+    assert(mCount > 0);
+    return quantile_of(weighted_items(), mCount, p);
+  }
+
+  std::vector<real> quantiles(const std::vector<real> &probs) const {
+    assert(mCount > 0);
+    const auto items = weighted_items();
+    std::vector<real> out(probs.size());
+    for (std::size_t j = 0; j < probs.size(); ++j) {
+      out[j] = quantile_of(items, mCount, probs[j]);
+    }
+    return out;
+  }
+
+  // Approximate fraction of values less than or equal to x
+  real cdf(const real x) const {
+    std::uint64_t below = 0;
+    for (std::size_t h = 0; h < mLevels.size(); ++h) {
+      for (const real y : mLevels[h]) {
+        below += y <= x ? std::uint64_t{1} << h : 0;
+      }
+    }
+    return mCount > 0 ? static_cast<real>(below) / static_cast<real>(mCount) : real{0.0};
+  }
+};
+
 } // namespace zoo
 
 #endif // ZOO_UTIL_HPP_